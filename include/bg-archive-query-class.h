@@ -0,0 +1,78 @@
+/**
+    bg-archive-query-class.h
+
+    A class which selects the rows of columnar archives (.bga) that satisfy
+    a set of range predicates, e.g. "TWS=8:12,|Heel|<25,|TWA|<90,|ROT|<3",
+    and writes just the requested columns of those rows to a .csv file.
+
+    Each block of an archive is scanned a column at a time: the predicates'
+    columns are decompressed and tested by vectorized kernels (SSE2, or NEON
+    on 64-bit ARM; scalar elsewhere) which AND their results into a selection
+    bitmap, 64 rows per word; the output columns are only decompressed if
+    some rows of the block were selected.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_ARCHIVE_QUERY_CLASS_H
+#define __BG_ARCHIVE_QUERY_CLASS_H
+
+#include "bg-archive-reader-class.h"
+#include "bg-column-bitset-class.h"
+#include "bg-csv-writer-class.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A row satisfies a predicate if its value (or its absolute value) is in [lo, hi]
+struct BgQueryPredicate
+{
+    string heading;
+    double lo;
+    double hi;
+    bool absolute;
+};
+
+class BgArchiveQuery
+{
+public:
+    BgArchiveQuery();
+    bool Parse(string const& where, string const& select);
+    bool Bind(BgArchiveReader& reader, string const& archiveFile);
+    bool Run(BgArchiveReader& reader, BgCsvWriter& writer);
+
+    vector<string>& Headers() { return m_headers; }
+    uint64_t Scanned() const { return m_scanned; }
+    uint64_t Selected() const { return m_selected; }
+
+    static void Select(const double* values, size_t count, BgQueryPredicate const& predicate, uint64_t* selection);
+    static const char* Kernel();
+
+private:
+    static bool ParsePredicate(string const& predicateTerm, BgQueryPredicate& predicate);
+
+    vector<BgQueryPredicate> m_predicates;
+    vector<string> m_select;        // the headings of the output columns ("" = all of the first archive's)
+    vector<string> m_headers;       // the output headings (with an empty heading after the last)
+    vector<unsigned char> m_precisions; // the output precisions (from the first archive)
+    vector<int> m_predicateCols;    // the archive columns of the predicates (for the bound archive)
+    vector<int> m_selectCols;       // the archive columns of the output (-1 = not in the archive)
+
+    // (Reused for each block)
+    vector<vector<double> > m_predicateValues;
+    vector<vector<double> > m_selectValues;
+    BgColumnBitset m_selection;
+    vector<double> m_row;
+    BgColumnBitset m_rowSeen;
+
+    uint64_t m_scanned;             // rows scanned
+    uint64_t m_selected;            // rows selected
+};
+
+#endif  // __BG_ARCHIVE_QUERY_CLASS_H
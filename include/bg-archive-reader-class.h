@@ -0,0 +1,64 @@
+/**
+    bg-archive-reader-class.h
+
+    A class which reads back a columnar archive written by BgArchiveWriter
+    (see that class for the file format), a block at a time, decompressing
+    only the columns asked for. A block's columns can be read in several
+    steps (e.g. the columns of a query's predicates, then, only if some rows
+    were selected, the columns to be output).
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_ARCHIVE_READER_CLASS_H
+#define __BG_ARCHIVE_READER_CLASS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class BgArchiveReader
+{
+public:
+    BgArchiveReader();
+    ~BgArchiveReader();
+    bool Open(string const& filename);
+    bool NextBlock(vector<int> const& cols, vector<vector<double> >& values, size_t& rows);
+    bool NextBlock(size_t& rows);
+    bool ReadColumns(vector<int> const& cols, vector<vector<double> >& values);
+
+    size_t Columns() const { return m_headers.size(); }
+    vector<string> const& Headers() const { return m_headers; }
+    vector<unsigned char> const& Precisions() const { return m_precisions; }
+    int Column(string const& heading) const;
+
+    bool Complete() const { return m_complete; }
+    uint64_t Rows() const { return m_rows; }
+    uint64_t RecordedRows() const { return m_recordedRows; }
+
+private:
+    bool Inflate(long offset, size_t bytes, size_t rows, vector<double>& values);
+
+    FILE* m_iFile;
+    vector<string> m_headers;
+    vector<unsigned char> m_precisions;
+    uint32_t m_blockRows;           // the most rows in a block
+    vector<uint32_t> m_sizes;       // compressed bytes of each column of the block
+    vector<long> m_offsets;         // file offset of each column of the block
+    long m_blockEnd;                // file offset of the next block (-1 = none read yet)
+    size_t m_rowsInBlock;           // rows in the block (0 = none read yet)
+    string m_compressed;
+    string m_shuffled;
+    uint64_t m_rows;                // rows read so far
+    uint64_t m_recordedRows;        // the total recorded after the end marker
+    bool m_complete;                // true once the end marker has been read
+};
+
+#endif  // __BG_ARCHIVE_READER_CLASS_H
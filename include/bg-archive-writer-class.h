@@ -0,0 +1,78 @@
+/**
+    bg-archive-writer-class.h
+
+    A class which writes CSV rows to a columnar, compressed archive (.bga),
+    for analysis (see BgArchiveReader). The rows are stored in blocks; within
+    a block each column is stored (and compressed) separately, so a reader
+    only decompresses the columns it needs, and a column with no values in
+    a block costs nothing.
+
+    File format (little-endian, as written by the converting machine):
+
+      "BGARC001"                  (magic; 8 bytes)
+      uint32 columns, uint32 block rows (the most rows in a block)
+      then, per column: the NUL-terminated heading and a uint8 precision
+      then, per block:
+        uint32 rows               (0 marks the end of the archive)
+        uint32 bytes[columns]     (compressed bytes of each column; 0 if the
+                                   column has no values in the block)
+        then each column's bytes: 'rows' float64 values (NaN where the row
+                                   has no value), byte-shuffled (the first
+                                   byte of every value, then the second, ...)
+                                   and deflated (raw deflate)
+      then, after the end marker: uint64 rows (the total, as a check)
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_ARCHIVE_WRITER_CLASS_H
+#define __BG_ARCHIVE_WRITER_CLASS_H
+
+#include "bg-column-bitset-class.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define BG_ARCHIVE_MAGIC "BGARC001"
+#define BG_ARCHIVE_MAGIC_LEN 8
+#define BG_ARCHIVE_BLOCK_ROWS 2048
+
+class BgArchiveWriter
+{
+public:
+    BgArchiveWriter();
+    ~BgArchiveWriter();
+    bool Open(string const& filename, vector<string> const& headers, vector<unsigned char> const& precisions);
+    void WriteRow(vector<double> const& values, BgColumnBitset const& seen);
+    void WriteRow(vector<double> const& values);
+    bool Close();
+
+    uint64_t Rows() const { return m_rows + m_blockRows; }
+    uint64_t Bytes() const { return m_bytes; }
+
+    static void Shuffle(const double* values, size_t count, unsigned char* bytes);
+    static void Unshuffle(const unsigned char* bytes, size_t count, double* values);
+
+private:
+    void WriteBlock();
+
+    FILE* m_oFile;
+    size_t m_columns;
+    vector<double> m_block;         // The rows of the block, by column (column * BG_ARCHIVE_BLOCK_ROWS + row)
+    vector<unsigned char> m_filled; // True if the column has a value in the block
+    size_t m_blockRows;             // rows in the block
+    uint64_t m_rows;                // rows written (in whole blocks)
+    uint64_t m_bytes;               // bytes written
+    vector<uint32_t> m_sizes;       // (reused for each block)
+    string m_shuffled;
+    string m_compressed;
+};
+
+#endif  // __BG_ARCHIVE_WRITER_CLASS_H
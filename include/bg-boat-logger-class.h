@@ -0,0 +1,157 @@
+/**
+    bg-boat-logger-class.h
+
+    A class which logs the data from one boat's H5000 CPU: it owns the
+    websocket session to the CPU, parses the incoming messages, aggregates
+    the observations into timestamped rows and writes them to the boat's own
+    output files.
+
+    Several boats can be logged by one process; each BgBoatLogger shares the
+    application's io_context (and data item definitions) but keeps its own
+    aggregation state, logging strand and output directory.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_BOAT_LOGGER_CLASS_H
+#define __BG_BOAT_LOGGER_CLASS_H
+
+#include "bg-observation-class.h"
+#include "bg-websocket-session-class.h"
+#include "bg-csv-writer-class.h"
+#include "bg-flat-writer-class.h"
+#include "bg-sparse-writer-class.h"
+#include "bg-capture-writer-class.h"
+#include "bg-rollup-writer-class.h"
+#include "bg-archive-writer-class.h"
+#include "bg-maneuver-detector-class.h"
+#include "bg-speed-calibrator-class.h"
+#include "bg-wind-calibrator-class.h"
+#include "bg-data-defs-class.h"
+#include "bg-row-accumulator-class.h"
+#include "bg-priority-filter-class.h"
+#include "json/json.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class H5000Logger;
+
+class BgBoatLogger {
+
+    friend class BgWebsocketSession;
+
+public:
+    BgBoatLogger(H5000Logger& app, int boat, string const& host, string const& port, string const& outDir);
+    ~BgBoatLogger();
+    void Start();
+    void ProcessObservation(BgObservation& o);
+    void ReportStats();
+    void ReplayFrame(string const& s, uint64_t monotonicNs, int64_t realtimeNs);
+    void ConvertTo(BgArchiveWriter* archiveWriter) { m_archiveWriter = archiveWriter; }
+    uint64_t ArchivedRows() const { return m_archivedRows; }
+    double ArchivedUtcSum() const { return m_archivedUtcSum; }
+
+    int Boat() const { return m_boat; }
+    string const& Label() const { return m_label; }
+
+protected:
+    void RequestAllValues();
+
+private:
+    // Incoming message handlers
+    void handleResponse(string const& s, uint64_t monotonicNs, int64_t realtimeNs);
+    void handleResponse(Json::Value& root, vector<BgObservation>& observations, int shedLevel);
+    void handleData(Json::Value& root, vector<BgObservation>& observations, int shedLevel);
+    int UpdateShedLevel(uint64_t monotonicNs);
+    void DeliverObservations(uint64_t seq, shared_ptr<vector<BgObservation> > observations);
+    void HandleObservations(vector<BgObservation>& observations);
+    static Json::Value ConstructJson(string const& sJson);
+    static void StampObservations(vector<BgObservation>& observations, uint64_t monotonicNs, int64_t realtimeNs);
+
+    // Aggregation of observations into timestamped rows
+    void NewDate(unsigned long int utcdate);
+    void OpenFiles(unsigned long int utcdate);
+    void NewTime(unsigned long int utctime);
+    void RollDate();
+    void WriteRow(double utcDateTime);
+    void RollupRow(double utcDateTime);
+    void OutputRow();
+    void Clear();
+    double Now();
+
+    // Timer-driven rows (-r)
+    void ScheduleRow();
+    chrono::steady_clock::time_point NextRowTime();
+    void EmitRow();
+
+    void ScheduleStats();
+
+private:
+    H5000Logger& m_app;             // The application (options, io_context, data definitions)
+    int m_boat;                     // Boat index (written to the "Boat" column)
+    string m_host;
+    string m_port;
+    string m_outDir;
+    string m_label;                 // Identifies the boat in console messages
+    bool m_debugFlag;
+    bool m_testFlag;
+    bool m_csvFlag;
+    bool m_flatFlag;
+
+    BgCsvWriter* m_csvWriter;
+    BgFlatWriter* m_flatWriter;
+    BgSparseWriter* m_sparseWriter; // Replaces m_csvWriter when the rows are written sparse (-x)
+    BgCaptureWriter* m_captureWriter;   // Raw frames, as received (-w)
+    BgRollupWriter* m_rollupWriter; // 10 s and 1 min summaries of the rows (-R)
+    BgArchiveWriter* m_archiveWriter;   // Replaces the .csv file when converting to an archive (-C; not owned)
+    uint64_t m_archivedRows;        // rows passed to m_archiveWriter (counted here, to verify the archive)
+    double m_archivedUtcSum;        // ... and the sum of their Utc values
+    BgManeuverDetector* m_maneuverDetector; // Tacks and gybes, written to the events file (-M)
+    BgWindCalibrator* m_windCalibrator; // Wind calibration estimated from the tacks and gybes (-W)
+    BgSpeedCalibrator* m_speedCalibrator;   // Boat speed calibration factors, by speed and heel (-B)
+    shared_ptr<BgWebsocketSession> m_session;
+    net::strand<net::io_context::executor_type> m_logStrand;   // Serializes observation processing
+    net::steady_timer m_statsTimer; // Schedules the periodic statistics report
+    net::steady_timer m_rowTimer;   // Schedules the timer-driven CSV rows (-r)
+
+    // Messages being parsed on worker threads (-n), reordered for processing
+    uint64_t m_nextFrameSeq;        // sequence number of the next message received
+    uint64_t m_nextDeliverSeq;      // sequence number of the next message to be processed
+    map<uint64_t, shared_ptr<vector<BgObservation> > > m_pendingFrames;
+
+    BgDataDefs& m_dataDefs;         // Tracked data items, CSV columns and precisions
+    int m_colDate;                  // (0-based) CSV columns of the items used for timestamping
+    int m_colTime;
+    int m_colUtc;
+    int m_colBoat;
+    BgRowAccumulator m_row;         // The observations for this timestamp (cleared/held per column policy)
+    uint64_t m_rawTimestamp;
+    unsigned long int m_rawDatestamp;   // The date when m_rawTimestamp was set
+    bool m_timestampSeen;           // true once the first date and time have been received (and the files opened)
+    unsigned long int m_fileDate;   // The date of the open output files
+
+    // Timer-driven rows: the row interval, and the GPS clock reference
+    chrono::milliseconds m_rowInterval;     // 0 = a row each time UTC time (id 35) advances
+    bool m_rowAlignGps;             // align rows to GPS time (true) or the system clock (false)
+    double m_rowUtc;                // Excel-compatible UTC of the next timer-driven row
+    double m_gpsTime;               // the most recent UTC time (id 35), in seconds since midnight
+    chrono::steady_clock::time_point m_gpsTimeAt;   // when m_gpsTime was received
+
+    bool m_firstObservation;        // true until the first valid observation has been processed
+
+    // Rate caps and shedding by priority class (-i)
+    BgPriorityFilter m_priorityFilter;
+    atomic<size_t> m_socketBacklog; // bytes waiting on the socket after the last frame was read
+};
+
+#endif  // __BG_BOAT_LOGGER_CLASS_H
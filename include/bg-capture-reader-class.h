@@ -0,0 +1,35 @@
+/**
+    bg-capture-reader-class.h
+
+    A class which reads back the raw websocket frames written to a capture
+    file by BgCaptureWriter (see that class for the file format).
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_CAPTURE_READER_CLASS_H
+#define __BG_CAPTURE_READER_CLASS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace std;
+
+class BgCaptureReader
+{
+public:
+    BgCaptureReader();
+    ~BgCaptureReader();
+    bool Open(string const& filename);
+    bool Next(string& frame, uint64_t& monotonicNs, int64_t& realtimeNs);
+
+private:
+    FILE* m_iFile;
+};
+
+#endif  // __BG_CAPTURE_READER_CLASS_H
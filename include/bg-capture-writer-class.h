@@ -0,0 +1,56 @@
+/**
+    bg-capture-writer-class.h
+
+    A class which appends the raw websocket frames received from an H5000
+    CPU to a capture file, so that a session can be replayed exactly (see
+    BgCaptureReader).
+
+    File format (little-endian, as written by the logging machine):
+
+      "BGCAP001"                  (magic; 8 bytes, at the start of the file)
+      then, per frame:
+        uint32 length             (bytes of frame text)
+        uint64 monotonic          (steady clock at receipt, ns)
+        int64 realtime            (system clock at receipt, ns since 1970)
+        the frame text            ('length' bytes, not terminated)
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_CAPTURE_WRITER_CLASS_H
+#define __BG_CAPTURE_WRITER_CLASS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define BG_CAPTURE_MAGIC "BGCAP001"
+#define BG_CAPTURE_MAGIC_LEN 8
+#define BG_CAPTURE_RECORD_HEADER 20     // length, monotonic and realtime
+
+class BgCaptureWriter
+{
+public:
+    BgCaptureWriter(string const& outDir);
+    ~BgCaptureWriter();
+    bool Open();
+    void WriteFrame(const void* data, size_t len, uint64_t monotonicNs, int64_t realtimeNs);
+
+    string const& FileName() const { return m_fileName; }
+
+private:
+    string m_outDir;
+    string m_fileName;
+    FILE* m_oFile;
+    vector<char> m_buffer;          // the file's stdio buffer
+    uint64_t m_flushNs;             // the receive time of the frame after which the file was last flushed
+};
+
+#endif  // __BG_CAPTURE_WRITER_CLASS_H
@@ -0,0 +1,112 @@
+/**
+    bg-column-bitset-class.h
+
+    A fixed-size set of bits, one per CSV column, packed into 64-bit words.
+
+    Used to flag which columns of a row have values to be written. Clearing
+    and counting work a word at a time, and the set bits can be visited in
+    order without testing each column in turn (rows are mostly empty).
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_COLUMN_BITSET_CLASS_H
+#define __BG_COLUMN_BITSET_CLASS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+
+using namespace std;
+
+class BgColumnBitset {
+
+public:
+    explicit BgColumnBitset(size_t bits = 0);
+    void Resize(size_t bits);
+    size_t Size() const { return m_bits; }
+
+    bool Test(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1; }
+    void Set(size_t i) { m_words[i >> 6] |= uint64_t(1) << (i & 63); }
+    void Reset(size_t i) { m_words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    void Assign(size_t i, bool value) { if (value) Set(i); else Reset(i); }
+
+    void ClearAll();
+    void SetAll();
+    size_t Count() const;
+
+    /**
+     * @brief Find the first set bit at or after a position.
+     * @param from The position at which to start looking.
+     * @return The position of the set bit, or Size() if there is none.
+     */
+    size_t Next(size_t from) const {
+        size_t w = from >> 6;
+        if (w >= m_words.size())
+            return m_bits;
+        uint64_t word = m_words[w] & (~uint64_t(0) << (from & 63));
+        while (word == 0)
+        {
+            if (++w == m_words.size())
+                return m_bits;
+            word = m_words[w];
+        }
+        return (w << 6) + LowestBit(word);
+    }
+
+    vector<uint64_t> const& Words() const { return m_words; }
+    vector<uint64_t>& Words() { return m_words; }   // (bits beyond Size() must be left clear)
+
+    static unsigned LowestBit(uint64_t word);
+    static unsigned PopCount(uint64_t word);
+
+private:
+    size_t m_bits;                  // number of bits (columns)
+    vector<uint64_t> m_words;       // the bits, 64 per word (bits beyond m_bits are always 0)
+};
+
+/**
+ * @brief The position of the lowest set bit of a (non-zero) word.
+*/
+inline unsigned BgColumnBitset::LowestBit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    unsigned n = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * @brief The number of set bits in a word.
+*/
+inline unsigned BgColumnBitset::PopCount(uint64_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+#endif  // __BG_COLUMN_BITSET_CLASS_H
@@ -18,6 +18,8 @@
 #define __BG_CSV_WRITER_H
 
 #include <bg-observation-class.h>
+#include "bg-column-bitset-class.h"
+#include "bg-frame-file-class.h"
 #include "json/json.h"
 
 #define MAX_CSV_COLUMNS 500
@@ -26,17 +28,19 @@ using namespace std;
 class BgCsvWriter
 {
 public:
-    BgCsvWriter(string& outDir);
-    void WriteObservations(vector<double>& observations, vector<unsigned char>& precisions, vector<bool>& seen);
+    BgCsvWriter(string& outDir, BgFileOptions const& options = BgFileOptions());
+    void WriteObservations(vector<double>& observations, vector<unsigned char>& precisions, BgColumnBitset& seen);
     void NewFile(unsigned long utcdate, vector<string>& trackedItems);
+    bool Open(string const& filename, vector<string>& trackedItems);
 private:
     string MakeFileName(unsigned long int utcdate);
 
 private:
     string MakeHeaderString(vector<string>& trackedItems);
+    string m_row;               // (reused for each row, to avoid reallocation)
     string m_outputFile;
     string m_outDir;
-    FILE* m_oFile;
+    BgFrameFile m_oFile;        // (compressed in frames, with -g; rotated, with -k/-m)
 };
 
 #endif  // __BG_CSV_WRITER_H
@@ -0,0 +1,192 @@
+/**
+    bg-data-defs-class.h
+
+    A class which holds the analyzed B&G data item definitions: which data
+    items are tracked in the Expedition-style .csv file, the column each one
+    occupies, and how each value is formatted.
+
+    The definitions are normally taken from a table compiled into the
+    application (see bg-data-defs-table.h, generated from
+    resources/BgDataDefs.json). A BgDataDefs.json file can optionally be
+    loaded at runtime to override the compiled-in table; the analyzed result
+    is then cached in a binary file alongside it (validated by a hash of the
+    JSON file), so later startups don't need to parse the JSON again.
+
+    An item with "Instances": N in BgDataDefs.json is logged for instances
+    0..N-1 (e.g. two depth sounders); instance 0 stays in the item's
+    Expedition column and the others get columns of their own.
+
+    "CsvPolicy" ("clear", "hold", "mean", "min", "max", "count" or
+    "circmean") and "CsvMaxAge" (seconds) select what an item's column
+    holds for each row; see BgRowAccumulator. "CsvStats" (e.g. ["min",
+    "max"]) adds a column for each of the listed statistics, headed
+    "HEADER_min", "HEADER_max", etc.
+
+    "FlatDeadband" (an absolute change, in the item's units),
+    "FlatDeadbandPct" (a change relative to the last value written, in
+    percent) and "FlatMaxSilence" (seconds) make the flat log change-only
+    for an item; see BgFlatWriter. "Priority" ("critical", "normal" or
+    "housekeeping"; "normal" if absent) sets the item's priority class; see
+    BgPriorityFilter. These apply to any item with an ID, whether or not it
+    is tracked in the .csv file.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_DATA_DEFS_CLASS_H
+#define __BG_DATA_DEFS_CLASS_H
+
+#include "json/json.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// What happens to a CSV column's value after each row is written
+enum BgCsvPolicy {
+    CSV_CLEAR = 0,              // reset to 0 (the Expedition default)
+    CSV_HOLD = 1,               // carry the last value forward (until it is older than maxAge)
+
+    // Statistics of the values observed during the row (empty if there were none)
+    CSV_MEAN = 2,               // mean
+    CSV_MIN = 3,                // minimum
+    CSV_MAX = 4,                // maximum
+    CSV_COUNT = 5,              // number of values
+    CSV_CIRCMEAN = 6,           // circular mean of an angle (degrees)
+    CSV_POLICIES
+};
+
+// An item's priority class, for rate limiting and for shedding under overload
+enum BgPriority {
+    PRIORITY_CRITICAL = 0,      // never limited or shed (boat speed, wind, heading, position)
+    PRIORITY_NORMAL = 1,        // the default
+    PRIORITY_HOUSEKEEPING = 2,  // shed first (battery and tank levels, etc.)
+    PRIORITIES
+};
+
+// A single (CSV-tracked) data item definition
+struct BgDataDef {
+    int id;                     // B&G data item id (-1 for Expedition-only columns)
+    const char* name;           // B&G data item name
+    int csvColumn;              // Expedition CSV column (1-based)
+    const char* csvHeader;      // Expedition CSV column heading
+    unsigned char decimals;     // digits written after the decimal point
+    int group;                  // B&G data group (0 if none)
+    const char* units;          // units ("" if none)
+    int instances;              // number of instances logged (0..instances-1)
+    unsigned char policy;       // BgCsvPolicy
+    double maxAge;              // CSV_HOLD: seconds a value is carried forward (0 = no limit)
+    int stats;                  // additional statistics columns (bit (1 << BgCsvPolicy) for each)
+    double deadband;            // flat log: minimum absolute change written (0 = none)
+    double deadbandPct;         // flat log: minimum change relative to the last value written, % (0 = none)
+    double maxSilence;          // flat log: seconds after which an unchanged value is written again (0 = never)
+    int priority;               // BgPriority
+};
+
+// The flat log change-only filter of one B&G data item (all 0 = every value is written)
+struct BgDeadband {
+    double abs;                 // minimum absolute change
+    double pct;                 // minimum relative change (%)
+    double maxSilence;          // seconds after which an unchanged value is written anyway
+};
+
+class BgDataDefs {
+
+public:
+    BgDataDefs();
+    void LoadCompiled();
+    bool LoadJson(string const& filename);
+    string const& Source() const { return m_source; }
+
+    /**
+     * @brief Look up the (0-based) CSV column for an instance of a B&G data item.
+     * @return The column index, or -1 if the item (or instance) is not tracked.
+     */
+    int CsvColumn(int id, int inst = 0) const {
+        if (id < 0 || id >= static_cast<int>(m_idSlots.size()))
+            return -1;
+        BgIdSlot const& slot = m_idSlots[id];
+        if (inst == 0)
+            return slot.col;
+        return (inst > 0 && inst < slot.instances) ? slot.instCol + inst - 1 : -1;
+    }
+
+    /**
+     * @brief Look up the additional statistics columns for an instance of a B&G data item.
+     * @param count Set to the number of statistics columns (0 if none).
+     * @return The (0-based) CSV column of the first of them.
+     */
+    int StatsColumns(int id, int inst, int& count) const {
+        count = 0;
+        if (id < 0 || id >= static_cast<int>(m_idSlots.size()))
+            return -1;
+        BgIdSlot const& slot = m_idSlots[id];
+        if (inst < 0 || inst >= slot.instances)
+            return -1;
+        count = slot.statCount;
+        return slot.statCol + inst * slot.statCount;
+    }
+    int Instances(int id) const {
+        return (id >= 0 && id < static_cast<int>(m_idSlots.size()) && m_idSlots[id].col >= 0) ? m_idSlots[id].instances : 1;
+    }
+    vector<int> const& MultiInstanceIds() const { return m_multiInstanceIds; }
+    int CsvColumn(string const& header) const;
+
+    size_t Columns() const { return m_headers.size(); }
+    vector<string>& Headers() { return m_headers; }
+    vector<unsigned char>& Precisions() { return m_precisions; }
+    vector<unsigned char> const& Policies() const { return m_policies; }
+    vector<double> const& MaxAges() const { return m_maxAges; }
+    vector<unsigned char> const& Angles() const { return m_angles; }
+    vector<BgDeadband> const& Deadbands() const { return m_deadbands; }
+    vector<unsigned char> const& Priorities() const { return m_priorities; }
+
+    static bool IsTracked(Json::Value& item);
+    static bool HasItemOptions(Json::Value& item);
+    static bool ParsePolicy(string const& name, unsigned char& policy);
+    static bool ParsePriority(string const& name, int& priority);
+    static const char* PriorityName(int priority);
+    static bool ParseStats(Json::Value& item, int& stats);
+
+private:
+    void Clear();
+    void Add(BgDataDef const& def);
+    void AddExtraColumns();
+    void AddColumn(string const& header, unsigned char precision, unsigned char policy, double maxAge, bool angle);
+    bool ParseJson(string const& filename, string const& cacheFile, uint64_t hash);
+    bool LoadCache(string const& cacheFile, uint64_t hash);
+    void SaveCache(string const& cacheFile, uint64_t hash, vector<BgDataDef> const& defs);
+    static bool HashFile(string const& filename, uint64_t& hash);
+
+    // The CSV columns of one B&G id: instance 0 keeps its Expedition column;
+    // instances 1..n-1, then the statistics columns of each instance, occupy
+    // consecutive columns after the Expedition ones
+    struct BgIdSlot {
+        int col;                        // 0-based CSV column of instance 0 (-1 if not tracked)
+        int instCol;                    // 0-based CSV column of instance 1
+        int instances;                  // number of instances tracked
+        int statCol;                    // 0-based CSV column of instance 0's first statistic
+        int statCount;                  // number of statistics columns per instance
+        int stats;                      // statistics (bit (1 << BgCsvPolicy) for each)
+    };
+
+    vector<BgIdSlot> m_idSlots;         // Dense B&G id -> CSV columns
+    vector<int> m_multiInstanceIds;     // B&G ids with more than one instance tracked
+    vector<BgDeadband> m_deadbands;     // Dense B&G id -> flat log change-only filter
+    vector<unsigned char> m_priorities; // Dense B&G id -> BgPriority (PRIORITY_NORMAL beyond the end)
+    vector<string> m_headers;           // Expedition column heading, by CSV column
+    vector<unsigned char> m_precisions; // Precision (after decimal point), by CSV column
+    vector<unsigned char> m_policies;   // BgCsvPolicy, by CSV column
+    vector<double> m_maxAges;           // Maximum age of a held value (seconds), by CSV column
+    vector<unsigned char> m_angles;     // True if the column is an angle in degrees, by CSV column
+    map<string, int> m_headerToCol;     // Expedition column heading -> 0-based CSV column
+    string m_source;                    // Where the definitions came from (for reporting)
+};
+
+#endif  // __BG_DATA_DEFS_CLASS_H
@@ -0,0 +1,376 @@
+/**
+    bg-data-defs-table.h
+
+    GENERATED FILE - DO NOT EDIT. Produced by src/tools/bg-data-defs-gen.cpp
+    from resources/BgDataDefs.json (run 'make' in build/gcc to regenerate).
+*/
+
+#ifndef __BG_DATA_DEFS_TABLE_H
+#define __BG_DATA_DEFS_TABLE_H
+
+#include "bg-data-defs-class.h"
+#include <cstddef>
+
+// id, name, csvColumn, csvHeader, decimals, group, units, instances, policy, maxAge, stats,
+// deadband, deadbandPct, maxSilence, priority
+constexpr BgDataDef g_bgDataDefs[] = {
+    { -1, "BackStay", 75, "BackStay", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "BelowLn", 111, "BelowLn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Blade", 157, "Blade", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Board", 52, "Board", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Board P", 56, "Board P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Boat", 1, "Boat", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Bobstay", 134, "Bobstay", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "BoomAng", 144, "BoomAng", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Board S", 57, "Bpard S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "BspTr", 131, "BspTr", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Burn", 110, "Burn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Cunningham", 145, "Cunningham", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "D0 P", 136, "D0 P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "D0 S", 137, "D0 S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "D1 P", 138, "D1 P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "D1 S", 139, "D1 S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "DeflectL", 164, "DeflectL", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "DeflectorP", 127, "DeflectorP", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "DeflectorS", 133, "DeflectorS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "DeflectU", 163, "DeflectU", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "DiffStn", 43, "DiffStn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "DistToLn", 58, "DistToLn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Downhaul", 23, "Downhaul", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Downhaul2", 64, "Downhaul2", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Error", 44, "Error", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Foil P", 154, "Foil P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Foil S", 155, "Foil S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "FStayInHal", 146, "FStayInHal", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "FStayInner", 132, "FStayInner", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "FStayLen", 25, "FStayLen", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "GPS time", 61, "GPS time", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "GpsAge", 35, "GpsAge", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "GpsMode", 38, "GpsMode", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "GunBlwLn", 112, "GunBlwLn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Heave", 118, "Heave", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "HeelRate", 126, "HeelRate", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "HPE", 71, "HPE", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "J1", 150, "J1", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "J2", 151, "J2", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "J3", 152, "J3", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "J4", 153, "J4", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "JibFurl", 147, "JibFurl", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "JibH", 148, "JibH", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "KeelAng", 50, "KeelAng", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "KeelHt", 51, "KeelHt", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Lead P", 73, "Lead P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Lead S", 74, "Lead S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Load P", 28, "Load P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Load S", 27, "Load S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Main", 49, "Main", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "MainH", 169, "MainH", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Mast2", 170, "Mast2", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "MastButt", 26, "MastButt", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "MastCant", 149, "MastCant", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Mk Lat", 65, "Mk Lat", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Mk Lon", 66, "Mk Lon", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "MWA", 119, "MWA", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "MWS", 120, "MWS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Oil P", 53, "Oil P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Outhaul", 135, "Outhaul", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Port lat", 67, "Port lat", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Port lon", 68, "Port lon", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Rake", 29, "Rake", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RchDtToLn", 60, "RchDtToLn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RchTmToLn", 59, "RchTmToLn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Reacher", 156, "Reacher", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RH", 72, "RH", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RPM 1", 54, "RPM 1", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RPM 2", 55, "RPM 2", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RudderFwd", 9, "RudderFwd", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RudderP", 128, "RudderP", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RudderS", 129, "RudderS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RudderToe", 130, "RudderToe", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RunnerP", 46, "RunnerP", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "RunnerS", 45, "RunnerS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Slam", 117, "Slam", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Solent", 159, "Solent", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "SpinP", 167, "SpinP", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "SpinS", 168, "SpinS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Staysail", 158, "Staysail", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Stbd lat", 69, "Stbd lat", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Stbd lon", 70, "Stbd lon", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Tab", 21, "Tab", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Tack", 160, "Tack", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TackLossD", 124, "TackLossD", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TackLossT", 123, "TackLossT", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TackP", 161, "TackP", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TackS", 162, "TackS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TmToGun", 108, "TmToGun", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TmToLn", 109, "TmToLn", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Trav", 48, "Trav", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TrimRate", 125, "TrimRate", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TWD+90", 62, "TWD+90", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "TWD-90", 63, "TWD-90", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Twist", 122, "Twist", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 0", 76, "User 0", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 1", 77, "User 1", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 10", 86, "User 10", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 11", 87, "User 11", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 12", 88, "User 12", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 13", 89, "User 13", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 14", 90, "User 14", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 15", 91, "User 15", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 16", 92, "User 16", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 17", 93, "User 17", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 18", 94, "User 18", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 19", 95, "User 19", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 2", 78, "User 2", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 20", 96, "User 20", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 21", 97, "User 21", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 22", 98, "User 22", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 23", 99, "User 23", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 24", 100, "User 24", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 25", 101, "User 25", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 26", 102, "User 26", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 27", 103, "User 27", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 28", 104, "User 28", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 29", 105, "User 29", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 3", 79, "User 3", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 30", 106, "User 30", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 31", 107, "User 31", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 4", 80, "User 4", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 5", 81, "User 5", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 6", 82, "User 6", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 7", 83, "User 7", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 8", 84, "User 8", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "User 9", 85, "User 9", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Utc", 2, "Utc", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "V0 P", 140, "V0 P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "V0 S", 141, "V0 S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "V1 P", 142, "V1 P", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "V1 2", 143, "V1 S", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "Vang", 47, "Vang", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "WinchP", 165, "WinchP", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "WinchS", 166, "WinchS", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "WvMaxHt", 115, "WvMaxHt", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "WvMaxPd", 116, "WvMaxPd", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "WvSigHt", 113, "WvSigHt", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { -1, "WvSigPd", 114, "WvSigPd", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 1, "Altitude", 36, "Altitude", 2, 1, "m", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 3, "Position Error", 200, "GpsPosError", 4, 1, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 4, "HDOP", 201, "HDOP", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 5, "VDOP", 202, "VDOP", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 6, "TDOP", 203, "TDOP", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 7, "PDOP", 33, "PDOP", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 8, "Geoidal Separation", 37, "GeoSep", 4, 28, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 9, "Course Over Ground", 41, "COG", 1, 1, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 10, "Position Quality", 32, "GpQual", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 11, "Position Integrity", 204, "GpsIntegrity", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 12, "Satellites in View", 34, "GpsNum", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 13, "SDGPS Status", 205, "WaasStatus", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 14, "Bearing to Waypoint", 206, "BTW", 1, 2, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 15, "Bearing Origin to Waypoint", 207, "BOTW", 1, 2, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 17, "Course to Steer", 208, "CTS", 1, 2, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 18, "Cross Track Error", 209, "XTE", 4, 2, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 19, "VMG to Waypoint", 210, "VmgWpt", 2, 2, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 20, "Destination", 211, "Dest", 5, 2, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 21, "Distance to Waypoint", 212, "Dist2Turn", 4, 2, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 22, "Distance to Destination", 213, "Dist2Dest", 5, 2, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 23, "Time to Waypoint", 214, "Time2Turn", 2, 29, "hrs", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 24, "Time to Destination", 215, "Time2Dest", 5, 29, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 25, "ETA at Waypoint", 216, "EtaTurn", 5, 29, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 26, "ETA at Destination", 217, "EtaDest", 5, 29, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 27, "Log", 218, "TotDist", 4, 29, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 28, "Steer Arrow", 219, "SteerArrow", 5, 2, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 29, "Odometer", 220, "Odometer", 5, 6, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 30, "Trip 1 Distance", 221, "TripDist", 4, 6, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 31, "Trip 1 Time", 222, "TripTime", 2, 6, "hrs", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 32, "Local Date", 223, "LocalDate", 5, 7, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 33, "Local Time", 224, "LocalTime", 2, 7, "hrs", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 34, "UTC Date", 225, "UtcDate", 5, 7, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 35, "UTC Time", 226, "UtcTime", 2, 7, "hrs", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 36, "Local Time Offset", 227, "LocalTimeOff", 5, 7, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 37, "Heading", 13, "HDG", 1, 3, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 38, "Voltage", 30, "Volts", 5, 27, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 39, "Tide Set", 11, "Set", 1, 27, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 40, "Tide Rate", 12, "Drift", 2, 27, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 41, "Speed over Ground", 42, "SOG", 2, 1, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 42, "Water Speed", 3, "BSP", 2, 4, "kn", 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 43, "Pitot Speed", 228, "PitotSpd", 2, 3, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 44, "Average Trip Speed", 229, "AvgTripSpd", 2, 6, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 45, "Maximum Trip Speed", 230, "MaxTripSpd", 2, 6, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 46, "Apparent Wind Speed", 5, "AWS", 2, 5, "kn", 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 47, "True Wind Speed", 7, "TWS", 2, 5, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 48, "Water Temperature", 15, "SeaTemp", 1, 4, "&deg;F", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 49, "Outside Temperature", 14, "AirTemp", 1, 5, "&deg;F", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 65, "Battery Temperature", 0, "", 1, 8, "&deg;F", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 66, "Barometric Pressure", 16, "Baro", 1, 5, "mb", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 77, "Depth", 17, "Depth", 2, 4, "ft", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 87, "Fuel Tank Level", 0, "", 5, 10, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 88, "Fresh Water Fluid Level", 0, "", 5, 11, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 89, "Gray Water Fluid Level", 0, "", 5, 12, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 90, "Live Well Fluid Level", 0, "", 5, 13, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 91, "Oil Fluid Level", 0, "", 5, 14, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 92, "Black Water Fluid Level", 0, "", 5, 15, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 93, "Fuel Remaining", 0, "", 5, 10, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 94, "Fresh Water Fluid Volume", 0, "", 5, 11, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 95, "Gray Water Fluid Volume", 0, "", 5, 12, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 96, "Live Well Fluid Volume", 0, "", 5, 13, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 97, "Oil Fluid Volume", 0, "", 5, 14, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 98, "Black Water Fluid Volume", 0, "", 5, 15, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 99, "Generic Fluid Volume", 0, "", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 105, "Generic Tank Capacity", 0, "", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 106, "Fuel Tank Capacity", 0, "", 5, 10, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 107, "Fresh Water Tank Capacity", 0, "", 5, 11, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 108, "Gray Water Tank Capacity", 0, "", 5, 12, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 109, "GrayLive Well Tank Capacity", 0, "", 5, 13, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 110, "Oil Tank Capacity", 0, "", 5, 14, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 111, "Black Water Tank Capacity", 0, "", 5, 15, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 112, "Tank Fuel Used", 0, "", 5, 10, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 113, "Engine Fuel Used", 0, "", 5, 8, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 114, "Trip Fuel Used", 0, "", 5, 8, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 115, "Seasonal Fuel Used", 0, "", 5, 8, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 117, "Battery Potential", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 118, "Battery Current", 0, "", 2, 22, "A", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 121, "Rate of Turn", 31, "ROT", 1, 3, "&deg;/sec", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 122, "Trim", 19, "Trim", 1, 3, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 125, "Magnetic Variation", 275, "VAR", 1, 27, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 137, "Vessel Fuel Remaining", 0, "", 5, 3, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 140, "Apparent Wind Angle", 4, "AWA", 1, 5, "&deg;", 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 141, "True Wind Angle", 6, "TWA", 1, 5, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 142, "True Wind Direction", 8, "TWD", 1, 5, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 146, "Rudder Angle", 20, "Rudder", 1, 23, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 150, "Commanded Rudder Angle", 276, "CMR", 1, 23, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 157, "Position Fix Type", 277, "GPF", 5, 28, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 161, "Generic Fluid Level", 0, "", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 165, "Depth Offset", 278, "DOF", 2, 28, "ft", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 169, "Battery DC Type", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 170, "Battery State of Charge", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 171, "Battery State of Health", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 172, "Battery Time Remaining", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 173, "Battery Ripple Voltage", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 174, "AC Input 1 Quality", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 175, "AC Input 2 Quality", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 176, "AC Input 3 Quality", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 177, "AC Input 1 Voltage", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 178, "AC Input 2 Voltage", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 179, "AC Input 3 Voltage", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 180, "AC Input 1 Current", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 181, "AC Input 2 Current", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 182, "AC Input 3 Current", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 183, "AC Input 1 Frequency", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 184, "AC Input 2 Frequency", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 185, "AC Input 3 Frequency", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 186, "AC Input 1 Breaker Size", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 187, "AC Input 2 Breaker Size", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 188, "AC Input 3 Breaker Size", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 189, "AC Input 1 Real Power", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 190, "AC Input 2 Real Power", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 191, "AC Input 3 Real Power", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 192, "AC Input 1 Reactive Power", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 193, "AC Input 2 Reactive Power", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 194, "AC Input 3 Reactive Power", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 195, "AC Input 1 Power Factor", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 196, "AC Input 2 Power Factor", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 197, "AC Input 3 Power Factor", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 213, "AC Input 1 Status", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 215, "Battery Capacity Remaining", 0, "", 5, 22, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 220, "Boom Position", 121, "Boom", 5, 35, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 221, "Sailing Course", 279, "CRS", 1, 35, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 224, "Heading Opposite Tack", 257, "HdgOppTack", 1, 35, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 226, "Leeway", 10, "Leeway", 1, 35, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 227, "Mast Angle", 24, "MastAng", 1, 35, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 228, "Target True Wind Angle", 235, "TargetTWA", 1, 35, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 230, "Race Timer", 236, "RaceTimer", 2, 35, "hrs", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 234, "Target Boat Speed", 231, "TargetSpd", 2, 35, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 235, "VMG to Windward", 232, "VmgWnd", 2, 35, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 239, "Forestay", 22, "Forestay", 5, 35, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 240, "Polar Speed", 233, "PolarSpd", 2, 35, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 241, "Polar Performance", 234, "PolarPct", 1, 35, "%", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 243, "Wind Angle to Mast", 237, "WndAngleMast", 1, 35, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 261, "AC Output 1 Quality", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 262, "AC Output 2 Quality", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 263, "AC Output 3 Quality", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 264, "AC Output 1 Voltage", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 265, "AC Output 2 Voltage", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 266, "AC Output 3 Voltage", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 267, "AC Output 1 Current", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 268, "AC Output 2 Current", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 269, "AC Output 3 Current", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 270, "AC Output 1 Frequency", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 271, "AC Output 2 Frequency", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 272, "AC Output 3 Frequency", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 273, "AC Output 1 Breaker Size", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 274, "AC Output 2 Breaker Size", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 275, "AC Output 3 Breaker Size", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 276, "AC Output 1 Real Power", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 277, "AC Output 2 Real Power", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 278, "AC Output 3 Real Power", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 279, "AC Output 1 Reactive Power", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 280, "AC Output 2 Reactive Power", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 281, "AC Output 3 Reactive Power", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 282, "AC Output 1 Power Factor", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 283, "AC Output 2 Power Factor", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 284, "AC Output 3 Power Factor", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 285, "AC Input 2 Status", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 286, "AC Input 3 Status", 0, "", 5, 25, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 287, "AC Output 1 Status", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 288, "AC Output 2 Status", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 289, "AC Output 3 Status", 0, "", 5, 36, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 294, "Charger Battery Instance", 0, "", 5, 37, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 295, "Charger Operating State", 0, "", 5, 37, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 296, "Charger Mode", 0, "", 5, 37, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 297, "Charger Enabled", 0, "", 5, 37, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 298, "Charger Equalization Pending", 0, "", 5, 37, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 299, "Charger Equalization Time Remaining", 0, "", 5, 37, "", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 309, "Bow Position Latitude", 39, "Lat", 5, 1, "", 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 310, "Bow Position Longitude", 40, "Lon", 5, 1, "", 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 317, "Dead Reckoning Bearing", 258, "DRBearing", 1, 0, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 318, "Dead Reckoning Distance", 259, "DRDistance", 4, 0, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 319, "Start Line Distance to Port", 238, "StartLnDistToS", 4, 0, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 320, "Start Line Distance to Starboard", 239, "StartLnDistToP", 4, 0, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 321, "Distance to Start Line", 240, "DistToStartLn", 4, 0, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 325, "Heel", 18, "Heel", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 331, "Measured Wind Angle", 241, "MeasuredWA", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 332, "Measured Wind Speed", 242, "MeasuredWS", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 336, "Optimum Wind Angle", 260, "OptWA", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 340, "Start Line Port Position Latitude", 280, "StartLnPLat", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 341, "Start Line Port Position Longitude", 281, "StartLnPLon", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 352, "Start Line Starboard Position Latitude", 282, "StartLnSLat", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 353, "Start Line Starboard Position Longitude", 283, "StartLnSLon", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 354, "Start Line Bias", 261, "StartLnBias", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 355, "Trip 2 Time", 284, "Trip2Tm", 2, 0, "hrs", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 356, "Trip 2 Distance", 285, "Trip2Dist", 4, 0, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 357, "VMG Performance", 262, "VMGPerf", 1, 0, "%", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 360, "Trip 2 Speed Average", 286, "Trip2SpAvg", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 361, "Trip 2 Speed Max", 287, "Trip2SpMax", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 383, "TWA Correction", 243, "TWACorr", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 384, "TWS Correction", 244, "TWSCorr", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 385, "Red Phase", 245, "RedPhase", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 386, "Green Phase", 246, "GreenPhase", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 387, "Blue Phase", 247, "BluePhase", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 404, "Corrected MWS", 248, "CorrMWS", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 405, "Corrected MWA", 249, "CorrMWA", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 406, "Orig TWS", 250, "OrigTWS", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 407, "Orig TWA", 251, "OrigTWA", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 408, "Orig TWD", 252, "OrigTWD", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 409, "Measured Boat Speed", 253, "MeasuredBSP", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 414, "Distance Behind Start Line", 263, "DistBehindStartLn", 4, 0, "NM", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 415, "Distance Behind Start Line (Boat Lengths)", 264, "DistBehindStartLnBL", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 437, "Measured Boat Speed Port", 254, "MeasuredBSPP", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 466, "Signed Leeway Angle", 256, "SignedLeewayAng", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 467, "Start Line Distance To Port (Boat Lengths)", 265, "StartLnDistPBL", 2, 0, "BL", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 468, "Start Line Distance To Starboard (Boat Lengths)", 266, "StartLnDistSBL", 2, 0, "BL", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 497, "Speed Through Water", 255, "SpdThruWater", 2, 0, "kn", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 498, "Pilot Active Perf Mode", 267, "PilotPerfMode", 5, 0, "", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 499, "Pilot Gust Bear Away", 268, "GBA", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 500, "Pilot TWS Bear Away", 269, "TWR", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 501, "Pilot Heel Compensation", 270, "HCP", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 502, "Pilot Net Course", 271, "NCR", 1, 0, "&deg;M", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 503, "Pilot Target Wind Angle", 272, "PTW", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 504, "Pilot Weather Helm", 273, "WHL", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 505, "Pilot Mean Heel", 274, "AHL", 1, 0, "&deg;", 1, 0, 0, 0, 0, 0, 0, 1 },
+    { 513, "Wireless Battery Status", 0, "", 1, 0, "%", 1, 0, 0, 0, 0, 0, 0, 2 },
+    { 514, "Wireless Battery Charge", 0, "", 1, 0, "%", 1, 0, 0, 0, 0, 0, 0, 2 },
+};
+
+constexpr size_t BG_DATA_DEFS_COUNT = 355;
+
+#endif  // __BG_DATA_DEFS_TABLE_H
@@ -4,6 +4,14 @@
     A class which writes 'data item' observations received from an H5000 CPU
     to a "flat" log file.
 
+    Items with a "FlatDeadband", "FlatDeadbandPct" or "FlatMaxSilence" in
+    BgDataDefs.json are written change-only: a value is skipped unless it
+    differs from the last value written for that item (and instance) by more
+    than the deadband, its validity changes, or "FlatMaxSilence" seconds have
+    passed since it was last written (a keepalive). With only "FlatMaxSilence",
+    any change is written. The UTC date and time (ids 34 and 35) are always
+    written.
+
     See: "GoFree Web Interface" / "Navico GoFree Tier 2 Websocket" documents for
     more detail (available for download from the B&G website) about data items.
 
@@ -18,22 +26,38 @@
 #define __BG_FLAT_WRITER_H
 
 #include <bg-observation-class.h>
+#include "bg-frame-file-class.h"
+#include "bg-data-defs-class.h"
+#include <cstdint>
+#include <vector>
 
 using namespace std;
 
 class BgFlatWriter
 {
 public:
-    BgFlatWriter(string& m_outDir);
+    BgFlatWriter(string& m_outDir, BgFileOptions const& options = BgFileOptions());
     void ProcessObservation(BgObservation& o);
     void NewFile(unsigned long int utcdate);
+    void SetDeadbands(vector<BgDeadband> const& deadbands);
 
 private:
     string MakeFileName(unsigned long int utcdate);
+    bool Changed(BgObservation& o);
+
+    // The last value written for a filtered item instance
+    struct LastValue {
+        double val;
+        int64_t ns;             // when it was written (steady clock, ns)
+        bool valid;
+        bool written;           // false until the first value is written
+    };
 
     string m_outDir;
-    FILE* m_oFile;
+    BgFrameFile m_oFile;        // (compressed in frames, with -g; rotated, with -k/-m)
 
+    vector<BgDeadband> m_deadbands;     // Dense B&G id -> change-only filter
+    vector<LastValue> m_last;           // Dense (id, instance) -> last value written
 };
 
 #endif  // __BG_FLAT_WRITER_H
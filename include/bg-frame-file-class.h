@@ -0,0 +1,117 @@
+/**
+    bg-frame-file-class.h
+
+    An output file which is either written directly (as plain text, flushed
+    at each record) or compressed in independent frames on a background
+    thread, and which can be rotated (continued in a new file) by size or
+    by age.
+
+    When compressing, the records written are collected until at least
+    'frameBytes' have accumulated, at a record boundary (Flush). The frame is
+    then handed to the background thread, which deflates it as a complete
+    gzip member, appends it to the file and flushes it. A file of such
+    members is an ordinary .gz file (gunzip and zcat read it as a whole), a
+    crash loses at most the frame being collected, and a reader can seek to
+    any member boundary and start decompressing there.
+
+    When rotating, each file opened is the first "part"; later parts are
+    named with a sequence number before the extension (e.g.
+    20200530-flatlog-001.log). The old part is closed (and, optionally,
+    compressed) on the background thread, and the new one is preallocated
+    there too, so a rotation costs the writing thread just an fopen.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_FRAME_FILE_CLASS_H
+#define __BG_FRAME_FILE_CLASS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+#define DEFAULT_COMPRESSION_LEVEL 6
+
+/**
+ * @brief How the output files are compressed and rotated (shared by all writers).
+*/
+struct BgFileOptions
+{
+    size_t frameBytes;              // minimum uncompressed bytes per compressed frame (0 = no compression)
+    size_t rotateBytes;             // start a new part after this many bytes (0 = no limit)
+    int rotateSeconds;              // start a new part after this many seconds (0 = no limit)
+    bool compressClosed;            // compress each (uncompressed) part once it is closed?
+
+    BgFileOptions() : frameBytes(0), rotateBytes(0), rotateSeconds(0), compressClosed(false) {}
+};
+
+class BgFrameFile
+{
+public:
+    BgFrameFile(BgFileOptions const& options = BgFileOptions(), int level = DEFAULT_COMPRESSION_LEVEL);
+    ~BgFrameFile();
+
+    bool Open(string const& filename, string const& header = "");
+    void Write(string const& s) { Write(s.data(), s.size()); }
+    void Write(const char* data, size_t len);
+    void Flush();
+    void Close();
+
+    bool IsOpen() const { return m_file != NULL; }
+    bool Compressed() const { return m_options.frameBytes > 0; }
+
+private:
+    // Work for the background thread, in the order queued
+    struct Job {
+        FILE* file;
+        size_t preallocate;         // bytes to reserve for the file (0 = none)
+        string data;                // a frame to be compressed and appended to the file
+        bool close;                 // close the file once the frame has been written?
+        string compressName;        // a (closed) file to be compressed, then removed
+    };
+
+    bool OpenPart();
+    bool RotationDue() const;
+    string PartName(int part) const;
+    static bool Exists(string const& filename);
+
+    void QueueJob(Job& job);
+    void QueueFrame(bool close);
+    void DoJobs();
+    void WriteMember(FILE* file, string const& data, string& out);
+    void CompressFile(string const& filename, string& out);
+    static void Preallocate(FILE* file, size_t bytes);
+    static void TrimPreallocation(FILE* file);
+
+    BgFileOptions m_options;
+    int m_level;                    // deflate compression level (1..9)
+    FILE* m_file;
+    string m_frame;                 // the frame being collected
+
+    // Rotation
+    string m_baseName;              // the name of the first part
+    string m_header;                // written at the start of each part
+    int m_part;                     // the current part (0 = the first)
+    size_t m_partBytes;             // uncompressed bytes written to the current part
+    chrono::steady_clock::time_point m_partStart;
+    bool m_preallocated;            // was the current part preallocated?
+
+    // Background compression, closing and preallocation
+    thread m_thread;
+    mutex m_mutex;
+    condition_variable m_ready;     // signals the background thread (jobs queued, or stopping)
+    deque<Job> m_jobs;
+    bool m_stopping;
+};
+
+#endif  // __BG_FRAME_FILE_CLASS_H
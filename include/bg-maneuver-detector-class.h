@@ -0,0 +1,154 @@
+/**
+    bg-maneuver-detector-class.h
+
+    A class which detects tacks and gybes in the stream of observations, as
+    they are processed, and writes each one (with the boat's state before
+    and after it) to an events file:
+
+      YYYYMMDD-h5000-maneuvers.csv    one row per tack or gybe
+
+    A turn starts when the rate of turn (id 121; else the rate of change of
+    the heading) exceeds 3 deg/s, and ends once it has stayed below 1 deg/s
+    for 2 seconds. The turn is a tack (or a gybe) if the true wind angle
+    changed sides, and was forward of (or aft of) the beam before the turn.
+
+    Each event holds the means of the heading, TWD, TWA, AWA, TWS, AWS, boat
+    speed and heel over a "pre" window (from 35 to 5 seconds before the turn)
+    and a "post" window (from 10 to 40 seconds after it; the instruments'
+    damping settles first), so that e.g. the shift in TWD across a tack can
+    be read straight from the file.
+
+    The work per observation is constant, and the state is bounded: the pre
+    window is kept as a ring of one second bins of sums, and the post window
+    as one set of sums.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_MANEUVER_DETECTOR_CLASS_H
+#define __BG_MANEUVER_DETECTOR_CLASS_H
+
+#include "bg-csv-writer-class.h"
+#include "bg-column-bitset-class.h"
+#include "bg-frame-file-class.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The items averaged over the pre and post windows
+enum BgManeuverChannel {
+    MANEUVER_HDG,
+    MANEUVER_TWD,
+    MANEUVER_TWA,
+    MANEUVER_AWA,
+    MANEUVER_TWS,
+    MANEUVER_AWS,
+    MANEUVER_BSP,
+    MANEUVER_HEEL,
+    MANEUVER_CHANNELS
+};
+
+enum BgManeuverType {
+    MANEUVER_TACK = 1,
+    MANEUVER_GYBE = 2
+};
+
+// The means of the channels over a window (valid[c] is false if channel c
+// wasn't observed during the window)
+struct BgManeuverWindow {
+    double mean[MANEUVER_CHANNELS];
+    bool valid[MANEUVER_CHANNELS];
+};
+
+struct BgManeuver {
+    int type;                       // BgManeuverType
+    double startUtc;                // Excel-compatible UTC of the start of the turn
+    double endUtc;                  // ... and of its end
+    double duration;                // seconds
+    double turn;                    // heading change (deg; positive = clockwise)
+    double minBsp;                  // the lowest boat speed during the turn (kn; -1 = not observed)
+    double postSeconds;             // the seconds of the post window observed (less if another turn began)
+    BgManeuverWindow pre;
+    BgManeuverWindow post;
+};
+
+class BgManeuverDetector {
+
+public:
+    BgManeuverDetector(string& outDir, int boat, BgFileOptions const& options = BgFileOptions());
+    ~BgManeuverDetector();
+    void NewFile(unsigned long int utcdate);
+    bool Observe(int id, double val, double now, double utcDateTime);
+    bool Flush();
+
+    BgManeuver const& LastManeuver() const { return m_maneuver; }
+    uint64_t Maneuvers() const { return m_maneuvers; }
+
+    static bool IsAngle(int channel) { return channel <= MANEUVER_AWA; }
+
+private:
+    // The sums of each channel's values over a period (angles as unit vectors)
+    struct Sums {
+        double sums[MANEUVER_CHANNELS];     // values (angles: sines)
+        double cosSums[MANEUVER_CHANNELS];  // angles: cosines
+        unsigned counts[MANEUVER_CHANNELS];
+        int64_t second;                     // the second summed (ring bins; -1 = none)
+    };
+
+    enum State { STEADY, TURNING };
+
+    static void Add(Sums& sums, int channel, double val);
+    static void Add(Sums& total, Sums const& sums);
+    static void Clear(Sums& sums);
+    static void Mean(Sums const& sums, BgManeuverWindow& window);
+    void StartTurn(double now, double utcDateTime);
+    void EndTurn(double now, double utcDateTime);
+    bool Emit();
+    void Write();
+
+    string m_outDir;
+    int m_boat;
+    BgCsvWriter m_writer;
+    vector<string> m_headers;
+    vector<unsigned char> m_precisions;
+    vector<double> m_row;
+    BgColumnBitset m_rowSeen;
+
+    // The latest values
+    double m_twa;                   // (NaN until observed)
+    double m_hdg;
+    double m_prevHdg;               // the heading before m_hdg
+    double m_rateHdg;               // the heading from which the rate of turn is derived (without id 121)
+    double m_rateAt;                // ... and when it was observed
+    double m_rate;                  // the latest rate of turn (deg/s)
+    bool m_haveRot;                 // true once a rate of turn (id 121) has been observed
+    int m_side;                     // the side the wind was last settled on (-1 = port, 1 = starboard, 0 = unknown)
+
+    // The turn being detected
+    State m_state;
+    double m_turnStart;             // when the turn started (the processing clock, s)
+    double m_turnStartUtc;
+    double m_lastFast;              // when the rate of turn was last above the end threshold
+    int m_startSide;
+    bool m_startForward;            // true if the TWA was forward of the beam at the start
+    double m_turn;                  // the heading change so far
+    double m_minBsp;
+
+    // The pre window (one second bins) and the post window
+    vector<Sums> m_ring;
+    Sums m_post;
+    double m_postStart;             // when the post window starts (the processing clock, s)
+    double m_now;                   // the processing clock at the latest observation
+
+    BgManeuver m_maneuver;          // the maneuver being completed (or the last one written)
+    bool m_pending;                 // true while m_maneuver's post window is being collected
+    uint64_t m_maneuvers;           // maneuvers written
+};
+
+#endif  // __BG_MANEUVER_DETECTOR_CLASS_H
@@ -17,11 +17,30 @@
 #ifndef __BG_OBSERVATION_H
 #define __BG_OBSERVATION_H
 
+#include <cstdint>
 #include <iostream>
 #include <json/json.h>
 
 using namespace std;
 
+// The ids of the data items used by the analysis code (e.g. the maneuver
+// detector; see BgDataDefs.json)
+enum BgItemId {
+    BG_ID_COG = 9,          // Course over ground (deg)
+    BG_ID_HDG = 37,         // Heading (deg)
+    BG_ID_SET = 39,         // Tide set (deg)
+    BG_ID_DRIFT = 40,       // Tide rate (kn)
+    BG_ID_SOG = 41,         // Speed over ground (kn)
+    BG_ID_BSP = 42,         // Water speed (kn)
+    BG_ID_AWS = 46,         // Apparent wind speed (kn)
+    BG_ID_TWS = 47,         // True wind speed (kn)
+    BG_ID_ROT = 121,        // Rate of turn (deg/s)
+    BG_ID_AWA = 140,        // Apparent wind angle (deg)
+    BG_ID_TWA = 141,        // True wind angle (deg)
+    BG_ID_TWD = 142,        // True wind direction (deg)
+    BG_ID_HEEL = 325        // Heel (deg)
+};
+
 class BgObservation {
 
 public:
@@ -33,6 +52,10 @@ public:
     bool isValid();					// Accessor for the 'valid' member variable
     string strVal();				// Accessor for the 'valStr' member variable
     double getVal();				// Accessor for the 'val' member variable
+    int getInst();					// Accessor for the 'inst' member variable
+    uint64_t getMonotonicNs();		// Accessor for the 'monotonicNs' member variable
+    int64_t getRealtimeNs();		// Accessor for the 'realtimeNs' member variable
+    void setReceived(uint64_t monotonicNs, int64_t realtimeNs);   // Stamp with the receive time
 
     string str();					// Provide a string representation of the observation
                                     // (this is what will be written to the flat log file)
@@ -47,6 +70,8 @@ private:
     bool m_valid;			// true if the data is valid
     bool m_damped;		// true if the data is damped
     double m_dampedVal;	// damped valued
+    uint64_t m_monotonicNs;	// steady clock when the message was received (ns; 0 = unknown)
+    int64_t m_realtimeNs;	// system clock when the message was received (ns since 1970; 0 = unknown)
 };
 
 #endif	// __BG_OBSERVATION_H
@@ -0,0 +1,84 @@
+/**
+    bg-priority-filter-class.h
+
+    A class which decides, per observation, whether it is processed or
+    dropped on the ingest path, by the priority class of its data item (see
+    BgPriority and the "Priority" of each item in BgDataDefs.json):
+
+      Rate caps   Each instance of a normal or housekeeping item is processed
+                  at most the configured number of times a second (-i); the
+                  rest are dropped. Critical items are never capped.
+      Shedding    When the logger falls behind the CPU (a message has waited
+                  too long to be parsed, or data is queued on the socket), the
+                  housekeeping items are dropped, and when it falls further
+                  behind, the normal items too, until it has caught up (and
+                  kept up for a second). How far behind it is, is judged as
+                  each message is taken up to be parsed, and the items to be
+                  shed are dropped by their id, before an observation is built
+                  for them. Critical items (and the UTC date and time) are
+                  never shed. (The message's JSON is parsed whole, so a
+                  critical item still waits for that.)
+
+    UpdateShedLevel and Shed may be called from any thread (the shedding
+    state is locked, and ShedLevel is atomic); Admit is called on the logging
+    strand. The counters are atomic, so they can be reported from any thread.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_PRIORITY_FILTER_CLASS_H
+#define __BG_PRIORITY_FILTER_CLASS_H
+
+#include "bg-data-defs-class.h"
+#include "bg-observation-class.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+// How far behind the logger is (the lowest priority still processed)
+enum BgShedLevel {
+    SHED_NONE = 0,              // everything is processed
+    SHED_HOUSEKEEPING = 1,      // housekeeping items are dropped
+    SHED_NORMAL = 2             // only critical items are processed
+};
+
+// The observations of one priority class dropped (or processed) so far
+struct BgPriorityCounts {
+    atomic<uint64_t> admitted;  // processed
+    atomic<uint64_t> limited;   // dropped by the class's rate cap
+    atomic<uint64_t> shed;      // dropped under overload
+};
+
+class BgPriorityFilter {
+
+public:
+    BgPriorityFilter();
+    void Init(BgDataDefs const& defs, vector<double> const& rates);
+    int UpdateShedLevel(int64_t lagNs, size_t backlogBytes, int64_t nowNs);
+    int ShedLevel() const { return m_shedLevel.load(memory_order_relaxed); }
+    bool Shed(int id, int shedLevel);
+    bool Admit(BgObservation& o);
+
+    int Priority(int id) const {
+        return (id >= 0 && static_cast<size_t>(id) < m_priorities.size()) ? m_priorities[id] : PRIORITY_NORMAL;
+    }
+    BgPriorityCounts const& Counts(int priority) const { return m_counts[priority]; }
+
+private:
+    vector<unsigned char> m_priorities; // Dense B&G id -> BgPriority (from BgDataDefs)
+    int64_t m_intervalNs[PRIORITIES];   // Minimum interval between an item's observations (0 = no cap)
+    vector<int64_t> m_lastNs;           // Dense (id, instance) -> receive time of the last one processed
+    BgPriorityCounts m_counts[PRIORITIES];
+    atomic<int> m_shedLevel;            // BgShedLevel
+    int64_t m_calmSinceNs;              // when the logger last caught up (0 = it hasn't)
+    mutex m_shedMutex;                  // (held while the shed level is updated)
+};
+
+#endif  // __BG_PRIORITY_FILTER_CLASS_H
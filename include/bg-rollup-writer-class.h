@@ -0,0 +1,88 @@
+/**
+    bg-rollup-writer-class.h
+
+    A class which rolls the rows of the .csv file up into 10 second and
+    1 minute summaries, as they are written, so that long periods (a whole
+    race, or a season) can be reviewed without reading every row:
+
+      YYYYMMDD-h5000-10s.csv      one row per 10 seconds of UTC time
+      YYYYMMDD-h5000-1min.csv     one row per minute
+
+    Each summary row holds the UTC time of the start of its period, the boat
+    number and the number of rows summarized, then, for each column of the
+    .csv file, HEADER_mean, HEADER_min and HEADER_max of the values observed
+    during the period (a value carried forward into later rows is counted
+    once). The columns of angles (in degrees) have the circular mean, and the
+    extremes of the angles either side of the first one in the period (so
+    the mean of 350 and 10 is 0, and their range is 350 to 10).
+
+    The statistics are updated incrementally, as each row is added, and a
+    summary row is written as soon as its period has passed.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_ROLLUP_WRITER_CLASS_H
+#define __BG_ROLLUP_WRITER_CLASS_H
+
+#include "bg-csv-writer-class.h"
+#include "bg-column-bitset-class.h"
+#include "bg-data-defs-class.h"
+#include "bg-frame-file-class.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class BgRollupWriter {
+
+public:
+    BgRollupWriter(string& outDir, BgDataDefs& defs, int boat, vector<int> const& skipCols,
+        BgFileOptions const& options = BgFileOptions());
+    ~BgRollupWriter();
+    void NewFile(unsigned long int utcdate);
+    void AddRow(double utcDateTime, vector<double> const& values, BgColumnBitset const& updated);
+    void Flush();
+
+private:
+    // One resolution of summary
+    struct Level {
+        int seconds;                    // the period of each summary row
+        const char* suffix;             // the file name suffix, e.g. "10s"
+        BgCsvWriter* writer;
+        int64_t period;                 // the period being summarized (UTC seconds / 'seconds'; -1 = none)
+        unsigned rows;                  // rows added during the period
+
+        // Per-column state (indexed by CSV column)
+        vector<unsigned> counts;        // values observed
+        vector<double> sums;            // sum of the values (or of their sines, for angles)
+        vector<double> cosSums;         // angles: sum of their cosines
+        vector<double> mins;            // minimum (for angles, the minimum offset from 'firsts')
+        vector<double> maxs;            // maximum (for angles, the maximum offset from 'firsts')
+        vector<double> firsts;          // angles: the first angle of the period
+        vector<unsigned char> negatives;    // angles: true if a negative angle was observed
+        vector<int> touched;            // the columns observed during the period
+    };
+
+    void Add(Level& level, vector<double> const& values, BgColumnBitset const& updated);
+    void WritePeriod(Level& level);
+    static double WrapAngle(double deg, bool negative);
+
+    string m_outDir;
+    int m_boat;
+    vector<int> m_dataCols;             // The CSV columns summarized
+    vector<unsigned char> m_angles;     // True if the column is an angle, by CSV column
+    vector<int> m_outCols;              // The first summary column of each CSV column (-1 if not summarized)
+    vector<string> m_headers;           // Summary column headings
+    vector<unsigned char> m_precisions; // Summary column precisions
+    vector<double> m_row;               // The summary row being written
+    BgColumnBitset m_rowSeen;           // The columns of the summary row that have values
+    Level m_levels[2];
+};
+
+#endif  // __BG_ROLLUP_WRITER_CLASS_H
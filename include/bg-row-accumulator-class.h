@@ -0,0 +1,121 @@
+/**
+    bg-row-accumulator-class.h
+
+    A class which accumulates the observations for one row of the
+    Expedition-style .csv file, applying each column's policy (see
+    BgCsvPolicy) when a row is written:
+
+      clear   The value is reset to 0 after each row (the Expedition default).
+      hold    The last value is carried forward into later rows, until it is
+              older than the column's maximum age (then the column is empty).
+      mean, min, max, count, circmean
+              The column holds a statistic of the values observed since
+              the last row (and is empty if there were none). "circmean" is
+              the circular mean of an angle in degrees (so the mean of 350
+              and 10 is 0, not 180).
+
+    The time each column was last updated is tracked, so held values can be
+    aged. The statistics are updated incrementally as each value arrives, in
+    constant time. The per-column state is kept in parallel arrays, and each
+    policy keeps a list of its columns, so the work done for each row is
+    proportional to the columns that need it.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_ROW_ACCUMULATOR_CLASS_H
+#define __BG_ROW_ACCUMULATOR_CLASS_H
+
+#include "bg-column-bitset-class.h"
+#include "bg-data-defs-class.h"
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+#define BG_PI 3.14159265358979323846
+
+class BgRowAccumulator {
+
+public:
+    BgRowAccumulator();
+    void Init(BgDataDefs const& defs, vector<int> const& keepCols);
+
+    /**
+     * @brief Record an observed value for a column.
+     * @param col The (0-based) CSV column.
+     * @param val The value.
+     * @param now The time of the observation (seconds, on the caller's clock).
+     */
+    void Set(int col, double val, double now) {
+        switch (m_policies[col]) {
+        case CSV_MEAN:
+            m_sums[col] += val;
+            val = m_sums[col] / ++m_counts[col];
+            break;
+        case CSV_MIN:
+            if (m_counts[col]++ != 0 && m_values[col] < val)
+                val = m_values[col];
+            break;
+        case CSV_MAX:
+            if (m_counts[col]++ != 0 && m_values[col] > val)
+                val = m_values[col];
+            break;
+        case CSV_COUNT:
+            val = ++m_counts[col];
+            break;
+        case CSV_CIRCMEAN:
+        {
+            // (Written from -180 to 180 if any of the angles were negative, else from 0 to 360)
+            double rad = val * (BG_PI / 180.0);
+            m_sums[col] += sin(rad);
+            m_cosSums[col] += cos(rad);
+            m_signed[col] |= (val < 0);
+            val = atan2(m_sums[col], m_cosSums[col]) * (180.0 / BG_PI);
+            if (val < 0 && !m_signed[col])
+                val += 360.0;
+            break;
+        }
+        default:
+            break;
+        }
+        m_values[col] = val;
+        m_seen.Set(col);
+        m_updated.Set(col);
+        m_times[col] = now;
+    }
+    double Value(int col) const { return m_values[col]; }
+    bool Seen(int col) const { return m_seen.Test(col); }
+    void SetSeen(int col, bool seen) { m_seen.Assign(col, seen); }
+
+    void Expire(double now);
+    void EndRow();
+
+    vector<double>& Values() { return m_values; }
+    BgColumnBitset& SeenFlags() { return m_seen; }
+    BgColumnBitset const& UpdatedFlags() const { return m_updated; }
+
+private:
+    // Per-column state (indexed by CSV column)
+    vector<double> m_values;        // The value to be written
+    BgColumnBitset m_seen;          // Set if the column is to be written
+    BgColumnBitset m_updated;       // Set if the column was observed during the row (not just carried forward)
+    vector<double> m_times;         // When the column was last updated
+    vector<double> m_sums;          // Statistics: sum of the values (or of their sines) during the row
+    vector<double> m_cosSums;       // CSV_CIRCMEAN: sum of the cosines of the angles during the row
+    vector<unsigned> m_counts;      // Statistics: number of values observed during the row
+    vector<unsigned char> m_signed; // CSV_CIRCMEAN: true if a negative angle was observed during the row
+    vector<unsigned char> m_policies;   // BgCsvPolicy
+
+    // The columns handled by each policy
+    vector<int> m_clearCols;
+    vector<int> m_holdCols;         // (only those with a maximum age)
+    vector<double> m_holdMaxAges;   // (parallel to m_holdCols)
+    vector<int> m_statCols;         // (mean, min, max, count and circmean)
+};
+
+#endif  // __BG_ROW_ACCUMULATOR_CLASS_H
@@ -0,0 +1,55 @@
+/**
+    bg-sparse-writer-class.h
+
+    A class which writes the CSV rows in a compact binary form: each row is
+    stored as its timestamp, the bitmap of the columns that have values, and
+    just those values. The files are converted to the full Expedition-style
+    .csv format on demand (see ConvertToCsv), so the bytes written for each
+    row depend on the data observed rather than on the number of columns.
+
+    File format (little-endian, as written by the logging machine):
+
+      'H' uint32 columns, then per column: the NUL-terminated heading and
+          a uint8 precision
+                                  (a header; written at the start of each
+                                   file, and again whenever the file is
+                                   re-opened for appending)
+      'R' float64 Utc, uint64 bitmap[(columns + 63) / 64], then a float64
+          value for each set bit, in column order
+                                  (a row)
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_SPARSE_WRITER_CLASS_H
+#define __BG_SPARSE_WRITER_CLASS_H
+
+#include "bg-column-bitset-class.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class BgSparseWriter
+{
+public:
+    BgSparseWriter(string& outDir);
+    void WriteObservations(double utc, vector<double>& observations, BgColumnBitset& seen);
+    void NewFile(unsigned long utcdate, vector<string>& trackedItems, vector<unsigned char>& precisions);
+
+    static long ConvertToCsv(string const& sparseFile, string const& csvFile);
+
+private:
+    string MakeFileName(unsigned long int utcdate);
+
+    string m_outDir;
+    FILE* m_oFile;
+    vector<char> m_record;          // (reused for each row, to avoid reallocation)
+};
+
+#endif  // __BG_SPARSE_WRITER_CLASS_H
@@ -0,0 +1,92 @@
+/**
+    bg-speed-calibrator-class.h
+
+    A class which compares the boat speed (BSP, from the paddle wheel) with
+    the GPS, as the observations are processed, and writes a table of the
+    speed calibration factors by boat speed and heel:
+
+      YYYYMMDD-h5000-speed-calibration.csv
+
+    Each BSP observation is compared with the latest SOG, and with the
+    speed through the water derived from the GPS: the velocity over the
+    ground (SOG, COG) less the current (drift, set), along the heading.
+    The factor (reference / BSP) is added to the bin of the boat speed (1
+    knot bands) and heel (5 degree bands), whose running mean and variance
+    are kept by Welford's method; the memory is fixed, and the work per
+    observation constant. Samples taken while turning (a rate of turn above
+    3 deg/s) are skipped, as the GPS lags the turn.
+
+    The factor against the SOG includes the current, which averages out
+    over reciprocal courses; the corrected factor is only as good as the
+    CPU's current estimate (which is itself derived from the boat speed,
+    unless the current is supplied from elsewhere).
+
+    The table is rewritten every 10 minutes, and at the end of the session.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_SPEED_CALIBRATOR_CLASS_H
+#define __BG_SPEED_CALIBRATOR_CLASS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+class BgSpeedCalibrator {
+
+public:
+    BgSpeedCalibrator(string& outDir, int boat);
+    ~BgSpeedCalibrator();
+    void NewFile(unsigned long int utcdate);
+    void Observe(int id, double val, double now);
+    bool WriteTable();
+
+    static const int SPEED_BANDS = 20;  // 0-1, 1-2, ... 19 kn and above
+    static const int HEEL_BANDS = 5;    // 0-5, 5-10, ... 20 deg and above
+
+private:
+    // The inputs of the comparison (the latest value of each, and when it was observed)
+    enum Input { IN_SOG, IN_COG, IN_HDG, IN_SET, IN_DRIFT, IN_HEEL, IN_ROT, INPUTS };
+
+    // A running mean and sum of squared deviations (Welford)
+    struct Stats {
+        uint64_t n;
+        double mean;
+        double m2;
+    };
+
+    struct Bin {
+        Stats bsp;
+        Stats sogFactor;
+        Stats correctedFactor;
+    };
+
+    bool Fresh(int input) const;
+    void Sample(double bsp);
+    static void Add(Stats& stats, double x);
+    static void Merge(Stats& total, Stats const& stats);
+    static void Clear(Stats& stats);
+    void WriteRow(ostream& out, double bspFrom, double bspTo, int heelFrom, int heelTo, Bin const& bin);
+
+    string m_outDir;
+    int m_boat;
+    string m_tableFile;             // (named for the date of the first file)
+    bool m_tableFailed;
+
+    double m_values[INPUTS];
+    double m_times[INPUTS];         // (-1 = not observed)
+    double m_now;
+    double m_nextWrite;             // when the table is next rewritten (the processing clock, s; -1 = unset)
+
+    Bin m_bins[SPEED_BANDS][HEEL_BANDS];
+    uint64_t m_samples;             // samples added to the bins
+};
+
+#endif  // __BG_SPEED_CALIBRATOR_CLASS_H
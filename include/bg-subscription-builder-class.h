@@ -0,0 +1,49 @@
+/**
+    bg-subscription-builder-class.h
+
+    A class which collects the data item ids to be requested from an H5000
+    CPU and builds the outgoing "DataInfoReq" / "DataReq" websocket messages,
+    packing as many ids into each message as the CPU will accept.
+
+    See: "GoFree Web Interface" / "Navico GoFree Tier 2 Websocket" documents for
+    more detail (available for download from the B&G website) about data items.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_SUBSCRIPTION_BUILDER_CLASS_H
+#define __BG_SUBSCRIPTION_BUILDER_CLASS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Default maximum number of data item ids in one request message
+#define DEFAULT_ITEMS_PER_FRAME 100
+
+class BgSubscriptionBuilder {
+
+public:
+    explicit BgSubscriptionBuilder(size_t maxItemsPerFrame = DEFAULT_ITEMS_PER_FRAME);
+    void Add(int id, int instances = 1);
+    void Add(vector<int> const& ids);
+    size_t Size() const { return m_ids.size(); }
+
+    vector<shared_ptr<string const> > Frames(bool infoOnly = false) const;
+
+    void AddDataItemArray(size_t first, size_t last, string& str) const;
+    static void AddIntArray(vector<int>::const_iterator first, vector<int>::const_iterator last, string& str);
+
+private:
+    size_t m_maxItemsPerFrame;      // maximum ids per message (as accepted by the CPU)
+    vector<int> m_ids;              // ids to be requested (in order, without duplicates)
+    vector<int> m_instances;        // indexed by id: instances to request (0 if the id isn't in m_ids)
+};
+
+#endif  // __BG_SUBSCRIPTION_BUILDER_CLASS_H
@@ -16,11 +16,18 @@
 // forward class definition to appease gcc when referenced in include file(s)
 class BgWebsocketSession; 
 
-#include "h5000-logger-class.h"
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/strand.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 //------------------------------------------------------------------------------
 // Preamble
@@ -29,26 +36,95 @@ namespace http = beast::http;           // from <boost/beast/http.hpp>
 namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
 namespace net = boost::asio;            // from <boost/asio.hpp>
 using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
-class H5000Logger;
+class BgBoatLogger;
+
+// A Beast rate policy that never limits the stream, but counts the bytes
+// actually transferred on the wire (i.e., after any compression)
+class BgByteCountingPolicy
+{
+    friend class beast::rate_policy_access;
+
+    static std::size_t constexpr all = (std::numeric_limits<std::size_t>::max)();
+    uint64_t m_bytesRead = 0;
+    uint64_t m_bytesWritten = 0;
+
+    std::size_t available_read_bytes() const noexcept { return all; }
+    std::size_t available_write_bytes() const noexcept { return all; }
+    void transfer_read_bytes(std::size_t n) noexcept { m_bytesRead += n; }
+    void transfer_write_bytes(std::size_t n) noexcept { m_bytesWritten += n; }
+    void on_timer() const noexcept {}
+
+public:
+    uint64_t BytesRead() const { return m_bytesRead; }
+    uint64_t BytesWritten() const { return m_bytesWritten; }
+};
+using bg_tcp_stream = beast::basic_stream<tcp, net::any_io_executor, BgByteCountingPolicy>;
+
+// Default bound on the number of outgoing messages waiting to be sent
+#define DEFAULT_QUEUE_LIMIT 256
+
+// What to do with a new outgoing message when the queue is full
+enum class QueuePolicy {
+    Coalesce,       // drop messages identical to one already queued; reject if still full
+    DropOldest,     // discard the oldest message not yet being written
+    Reject          // discard the new message
+};
+
+// Outgoing queue and incoming frame statistics
+struct BgSessionStats {
+    size_t queueDepth;          // messages currently queued (including the one being written)
+    size_t maxQueueDepth;       // high-water mark of queueDepth
+    uint64_t messagesSent;      // messages written to the server
+    uint64_t coalesced;         // messages dropped as duplicates of a queued message
+    uint64_t dropped;           // queued messages discarded to make room (DropOldest)
+    uint64_t rejected;          // new messages discarded because the queue was full
+    uint64_t framesRead;        // messages received from the server
+    uint64_t bytesRead;         // payload bytes received from the server (after decompression)
+    uint64_t wireBytesRead;     // bytes received on the TCP connection (as sent, possibly compressed)
+    uint64_t readWaitCpuNs;     // CPU time of the session's thread while reads were outstanding (approximate:
+                                // receiving and inflating frames, but also whatever else the thread ran meanwhile,
+                                // e.g. other boats' parsing, CSV rows and timers)
+    bool deflate;               // true if permessage-deflate was negotiated
+};
 
 //------------------------------------------------------------------------------
 // Class definition
 class BgWebsocketSession : public std::enable_shared_from_this<BgWebsocketSession>
 {
-    H5000Logger* m_app;                                     // pointer to the application object (contains message handlers)
+    BgBoatLogger* m_app;                                    // pointer to the boat logger (contains message handlers)
     std::string m_host;										// hostname (fqdn) or ip address of the websocket server
     bool m_debugFlag;
     bool m_testFlag;
     tcp::resolver m_resolver;								// for resolving fqdn to ip address
-    websocket::stream<beast::tcp_stream> m_ws;				// the websocket communication object
+    websocket::stream<bg_tcp_stream> m_ws;					// the websocket communication object
     beast::flat_buffer m_buffer;								// a buffer to hold websocket i/o
-    std::vector<std::shared_ptr<std::string const>> m_queue;	// a queue of messages to be sent to the h5000 websocket
+    std::deque<std::shared_ptr<std::string const>> m_queue;	// a queue of messages to be sent to the h5000 websocket
+    size_t m_queueLimit;									// maximum number of messages in m_queue
+    QueuePolicy m_queuePolicy;								// what to do when m_queue is full
+    bool m_writing;											// true while m_queue.front() is being written
+    std::atomic<bool> m_closed;								// true once the session has closed or failed (read off the session strand)
+    BgSessionStats m_stats;
+    bool m_deflateFlag;										// offer permessage-deflate?
+    int m_deflateWindowBits;								// deflate window bits (9..15)
+    int m_deflateMemLevel;									// deflate memory level (1..9)
+    websocket::response_type m_handshakeResponse;			// the server's handshake response
+    uint64_t m_cpuMark;										// thread CPU time when the last read was started
+    std::thread::id m_cpuThread;							// the thread m_cpuMark was taken on
+    std::chrono::steady_clock::time_point m_handshakeTime;	// when the websocket handshake completed
 
 public:
-    explicit BgWebsocketSession(H5000Logger* pApp, net::io_context& ioc, bool debugFlag, bool testFlag);
+    explicit BgWebsocketSession(BgBoatLogger* pApp, net::io_context& ioc, bool debugFlag, bool testFlag);
     ~BgWebsocketSession();
     void run(char const* host, char const* port);
-    void send(shared_ptr<string const> const& ss);
+    void send(std::shared_ptr<std::string const> const& ss);
+    void send(std::vector<std::shared_ptr<std::string const>> const& messages);
+    std::chrono::steady_clock::time_point HandshakeTime() const { return m_handshakeTime; }
+    void SetQueueLimit(size_t limit, QueuePolicy policy);
+    void SetDeflate(int windowBits, int memLevel);
+    BgSessionStats const& Stats();
+    size_t QueueLimit() const { return m_queueLimit; }
+    bool Closed() const { return m_closed; }
+    net::any_io_executor get_executor() { return m_ws.get_executor(); }
 
 private:
     // Websocket async handlers
@@ -59,6 +135,10 @@ private:
     void on_write(beast::error_code ec, std::size_t bytes_transferred);
     void on_close(beast::error_code ec);
     void fail(beast::error_code ec, char const* what);
+    void write_front();
+    bool enqueue(std::shared_ptr<std::string const> const& ss);
+    void start_read();
+    static uint64_t thread_cpu_ns();
 };
 
 #endif	// __BG_WEBSOCKET_SESSION_CLASS_H
@@ -0,0 +1,121 @@
+/**
+    bg-wind-calibrator-class.h
+
+    A class which estimates corrections to the wind calibration from the
+    tacks and gybes found by BgManeuverDetector, and writes them (with the
+    residuals) to a report:
+
+      YYYYMMDD-h5000-wind-calibration.txt
+
+    The TWD should be the same before and after a tack or gybe. A shift
+    across one is taken to be caused by an error in the true wind angle of
+
+        side x (a + b x TWS) + c x heel
+
+    (side = 1 with the wind to starboard, -1 to port: an upwash error which
+    grows with the wind speed, and a heel error). The change in the error
+    across each maneuver is fitted to the TWD shifts by least squares,
+    separately for tacks (upwind) and gybes (downwind). The wind angle offset
+    is taken from the apparent wind angle, which should be mirrored across a
+    maneuver: its mean asymmetry is the misalignment of the masthead unit.
+
+    Each maneuver adds to the sums of the normal equations (constant work,
+    and fixed memory: only the last 50 maneuvers are kept, for the table of
+    residuals). The estimates are solved from the sums each time the report
+    is written: every 10 minutes, and at the end of the session.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#ifndef __BG_WIND_CALIBRATOR_CLASS_H
+#define __BG_WIND_CALIBRATOR_CLASS_H
+
+#include "bg-maneuver-detector-class.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+// The parameters of the TWA error model
+enum BgWindParameter {
+    WIND_UPWASH,                    // a: deg
+    WIND_UPWASH_TWS,                // b: deg per knot of TWS
+    WIND_HEEL,                      // c: deg per degree of heel
+    WIND_PARAMETERS
+};
+
+class BgWindCalibrator {
+
+public:
+    BgWindCalibrator(string& outDir, int boat);
+    ~BgWindCalibrator();
+    void NewFile(unsigned long int utcdate);
+    void Tick(double now);
+    bool AddManeuver(BgManeuver const& maneuver);
+    bool WriteReport();
+
+    static const int MAX_SAMPLES = 50;  // the maneuvers in the table of residuals
+
+private:
+    // The sums of the normal equations of the fit to one type of maneuver
+    struct Fit {
+        uint64_t n;
+        double xtx[WIND_PARAMETERS][WIND_PARAMETERS];
+        double xty[WIND_PARAMETERS];
+        double yty;
+        double minTws;
+        double maxTws;
+    };
+
+    // A fitted model (from a Fit's sums)
+    struct Solution {
+        bool used[WIND_PARAMETERS];     // the parameters that could be estimated
+        double beta[WIND_PARAMETERS];
+        double stdErr[WIND_PARAMETERS]; // (-1 = no degrees of freedom)
+        double rmsBefore;               // the RMS TWD shift (deg)
+        double rmsAfter;                // ... after the corrections
+    };
+
+    // A maneuver that was used (for the table of residuals)
+    struct Sample {
+        double utc;
+        int type;
+        double tws;
+        double x[WIND_PARAMETERS];
+        double y;                       // the TWD shift
+        double asymmetry;               // the AWA asymmetry (NaN = AWA not observed)
+    };
+
+    static void Clear(Fit& fit);
+    static void Solve(Fit const& fit, Solution& solution);
+    static bool Invert(Fit const& fit, bool const used[WIND_PARAMETERS], double inv[WIND_PARAMETERS][WIND_PARAMETERS]);
+    void Report(ostream& out);
+    void ReportFit(ostream& out, Fit const& fit, Solution const& solution, char const* name);
+
+    string m_outDir;
+    int m_boat;
+    string m_reportFile;            // (named for the date of the first file)
+    bool m_reportFailed;
+
+    Fit m_fits[2];                  // tacks, gybes
+    uint64_t m_rejected;            // maneuvers not used (windows incomplete, or too large a shift)
+
+    // The AWA asymmetry (Welford's running mean and sum of squared deviations)
+    uint64_t m_asymmetryN;
+    double m_asymmetryMean;
+    double m_asymmetryM2;
+
+    double m_firstUtc;              // the first and last maneuvers used
+    double m_lastUtc;
+    double m_nextWrite;             // when the report is next rewritten (the processing clock, s; -1 = unset)
+
+    Sample m_samples[MAX_SAMPLES];  // the last maneuvers used (a ring)
+    uint64_t m_sampleCount;         // maneuvers added to the ring
+};
+
+#endif  // __BG_WIND_CALIBRATOR_CLASS_H
@@ -13,12 +13,24 @@
 #ifndef __H5000_LOGGER_CLASS_H
 #define __H5000_LOGGER_CLASS_H
 
+#include "bg-boat-logger-class.h"
 #include "bg-observation-class.h"
 #include "bg-websocket-session-class.h"
 #include "bg-csv-writer-class.h"
 #include "bg-flat-writer-class.h"
+#include "bg-sparse-writer-class.h"
+#include "bg-capture-reader-class.h"
+#include "bg-archive-writer-class.h"
+#include "bg-archive-reader-class.h"
+#include "bg-archive-query-class.h"
+#include "bg-data-defs-class.h"
+#include "bg-subscription-builder-class.h"
 #include "json/json.h"
+#include <chrono>
+#include <map>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -28,34 +40,36 @@ using namespace std;
 
 class H5000Logger {
 
-    friend class BgWebsocketSession;
+    friend class BgBoatLogger;
 
 public:
     H5000Logger(int argc_, char** argv_);
     int run();
 
-protected:
-    void RequestAllValues();
-
 private:
-    // Main communication/logging routines
-    void RequestDataValues(vector<int> items);
-    void RequestDataInfo(vector<int> items);
-    void handleData(Json::Value& root);
-    void handleResponse(Json::Value& root);
-    void handleResponse(string const& s);
-    bool AnalyzeDataDefs();
     bool LoadDataDefs();
-    void handleMany(Json::Value& root);
+    bool MakeOutputDirectory(string const& dir);
 
     // Helper functions
     void ProcessCommandLine(int argc, char** argv);
-    void AddDataItemArray(vector<int> array, string& str);
-    void AddIntArray(vector<int> array, string& str);
-    Json::Value ConstructJson(string sJson);
+    void ParseHostOption(string const& arg);
+    void ParseQueueOption(string const& arg);
+    void ParseDeflateOption(string const& arg);
+    void ParseAlignOption(string const& arg);
+    void ParseRateOption(string const& arg);
     void Usage();
 
     int ProcessFlatLog();
+    int ConvertSparseFile();
+    int ReplayCapture();
+    int ConvertToArchives();
+    bool ConvertToArchive(string const& inFile, string& report);
+    bool ConvertCsvFile(string const& inFile, BgArchiveWriter& writer, string const& archiveFile, uint64_t& rows,
+        double& utcSum);
+    bool ConvertFlatLog(string const& inFile, BgArchiveWriter& writer, string const& archiveFile, uint64_t& rows,
+        double& utcSum);
+    static bool VerifyArchive(string const& archiveFile, uint64_t rows, double utcSum, string& report);
+    int QueryArchives();
 
 
 private:
@@ -68,46 +82,54 @@ private:
     bool m_testFlag;            // just test connection?
     bool m_csvFlag;             // produce CSV file output?
     bool m_flatFlag;            // produce "flatfile" output?
+    bool m_dataDefsFlag;        // override the compiled-in data definitions?
+    bool m_sparseFlag;          // write the CSV rows in the sparse binary format?
+    bool m_convertFlag;         // convert a sparse file to .csv?
+    bool m_captureFlag;         // capture the raw frames received?
+    bool m_replayFlag;          // replay a capture file?
+    bool m_replayRealtime;      // replay at the recorded speed (else as fast as possible)?
+    bool m_rollupFlag;          // write 10 s and 1 min summaries of the CSV rows?
+    bool m_archiveFlag;         // convert files to columnar archives (.bga)?
+    bool m_queryFlag;           // query columnar archives?
+    bool m_maneuverFlag;        // detect tacks and gybes, and write them to an events file?
+    bool m_windCalibrationFlag; // estimate the wind calibration from the tacks and gybes?
+    bool m_speedCalibrationFlag;    // compare the boat speed with the GPS, by speed and heel?
 
     // corresponding argument values
-    string m_host;
+    vector<pair<string, string> > m_hosts;  // (host, port) of each boat's H5000 CPU ("" port = use -p)
     string m_port;
     string m_outDir;
     string m_inputLogFile;
+    string m_sparseFile;        // sparse file to be converted to .csv (-u)
+    string m_replayFile;        // capture file to be replayed (-y)
+    vector<string> m_inputFiles;    // the files listed after the options: to be converted (-C) or queried (-Q/-S)
+    string m_queryWhere;        // the predicates of an archive query (-Q)
+    string m_querySelect;       // the columns written by an archive query (-S)
+    string m_dataDefsFile;
+    size_t m_itemsPerFrame;     // maximum data item ids per subscription message
+    size_t m_queueLimit;        // maximum outgoing messages queued in the session
+    QueuePolicy m_queuePolicy;  // what to do when the outgoing queue is full
+    int m_statsInterval;        // seconds between statistics reports (0 = none)
+    bool m_deflateFlag;         // offer permessage-deflate compression?
+    int m_deflateWindowBits;    // deflate window bits (9..15)
+    int m_deflateMemLevel;      // deflate memory level (1..9)
+    int m_threads;              // number of threads running the io_context
+    chrono::milliseconds m_rowInterval; // interval between timer-driven CSV rows (0 = on UTC time)
+    vector<double> m_priorityRates; // maximum observations/s of an item, by BgPriority (0 = no cap)
+    bool m_rowAlignGps;         // align timer-driven rows to GPS time (else the system clock)
+    BgFileOptions m_fileOptions;    // output file compression and rotation
     string m_exePath;
 
-    BgCsvWriter* m_csvWriter;
-    BgFlatWriter* m_flatWriter;
-
-    // Core actions
-    void ProcessObservation(BgObservation& o);
-    bool WriteToCsvTest(Json::Value& item);
-
-    // Helper functions
-    void NewDate(unsigned long int utcdate);
-    void Clear();
-    void NewTime(unsigned long int utctime);
-
 public:
-    shared_ptr<BgWebsocketSession> m_session;
+    net::io_context m_ioc;          // The io_context is required for all I/O (shared by all boats)
+    vector<unique_ptr<BgBoatLogger> > m_boats;  // One logger per boat/H5000 CPU
 
-
-
-
-
-    map<int, int> m_bgToCsvMap;     // Map for translating B&G DataItem IDs to Expedition CSV columns
-    vector<double> m_observations;  // Vector of observations for this timestamp (overwritten for each new time)
-    map<string, int> m_ExpNameToCsvCol; // Map to translate an Expedition column name to the corresponding column number
-    map<int, string> m_CsvColtoExpName; // Map to translate a column number to the corresponding Expedition column name
-    map<int, string> m_BgIDToBgName;    // Map to translate an ID value to the corresponding B&G DataItem name
-    vector<bool> m_obsSeen;         // Elements are set to True when the corresponding observation has been seen
-    uint64_t m_rawTimestamp;
-    Json::Value m_bgDataDefs;
-    vector<string> m_csvTrackedItems;
-    vector<unsigned char> m_precisions; // Vector with precision (after decimal point) for each data item
-    map<string, int> m_BgNameToBgID;    // Map to translate a B&G DataItem name to its corrsponding ID value
+    BgDataDefs m_dataDefs;          // Tracked data items, CSV columns and precisions
 
     FILE* m_iFile;
+
+    // Startup metrics (to measure the window of data lost on each restart)
+    chrono::steady_clock::time_point m_startTime;
 };
 
 #endif	// __H5000_LOGGER_CLASS_H
@@ -0,0 +1,363 @@
+/**
+    bg-archive-query-class.cpp
+
+    A class which selects the rows of columnar archives that satisfy a set
+    of range predicates, and writes the requested columns of those rows.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-archive-query-class.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+// The predicate kernels: SSE2 (every x64 CPU), NEON (64-bit ARM, e.g. a
+// Raspberry Pi running a 64-bit OS), else scalar
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BG_QUERY_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BG_QUERY_NEON
+#endif
+
+BgArchiveQuery::BgArchiveQuery() :
+    m_scanned(0), m_selected(0)
+{
+}
+
+/**
+ * @brief Parse the query.
+ *
+ * @param where The predicates, separated by commas; each is one of
+ *      NAME=LO:HI (LO <= value <= HI), NAME=V, NAME<V or NAME>V, where NAME
+ *      is a column heading; |NAME| tests the absolute value. A row is
+ *      selected if it satisfies every predicate ("" selects every row).
+ * @param select The headings of the columns to be written, separated by
+ *      commas ("" = every column of the first archive).
+ * @return True if successful.
+*/
+bool BgArchiveQuery::Parse(string const& where, string const& select)
+{
+    size_t start = 0;
+    while (start < where.size())
+    {
+        size_t comma = where.find(',', start);
+        if (comma == string::npos)
+            comma = where.size();
+        BgQueryPredicate predicate;
+        if (!ParsePredicate(where.substr(start, comma - start), predicate))
+        {
+            cerr << "Invalid query predicate: " << where.substr(start, comma - start) << endl;
+            return false;
+        }
+        m_predicates.push_back(predicate);
+        start = comma + 1;
+    }
+
+    start = 0;
+    while (start < select.size())
+    {
+        size_t comma = select.find(',', start);
+        if (comma == string::npos)
+            comma = select.size();
+        m_select.push_back(select.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse one predicate (see Parse).
+ *
+ * @param predicateTerm The predicate, e.g. "TWS=8:12" or "|Heel|<25".
+ * @param predicate Set to the predicate.
+ * @return True if successful.
+*/
+bool BgArchiveQuery::ParsePredicate(string const& predicateTerm, BgQueryPredicate& predicate)
+{
+    size_t pos = predicateTerm.find_first_not_of(' ');
+    if (pos == string::npos)
+        return false;
+    string term = predicateTerm.substr(pos);
+
+    // The heading (|NAME| for the absolute value), then the operator
+    size_t op;
+    predicate.absolute = (!term.empty() && term[0] == '|');
+    if (predicate.absolute)
+    {
+        size_t close = term.find('|', 1);
+        if (close == string::npos)
+            return false;
+        predicate.heading = term.substr(1, close - 1);
+        op = term.find_first_not_of(' ', close + 1);
+        if (op == string::npos || string("<>=").find(term[op]) == string::npos)
+            return false;
+    }
+    else
+    {
+        op = term.find_first_of("<>=");
+        if (op == string::npos)
+            return false;
+        predicate.heading = term.substr(0, op);
+    }
+    size_t first = predicate.heading.find_first_not_of(' ');
+    size_t last = predicate.heading.find_last_not_of(' ');
+    if (first == string::npos || op >= term.size())
+        return false;
+    predicate.heading = predicate.heading.substr(first, last - first + 1);
+
+    // The value(s)
+    const double inf = numeric_limits<double>::infinity();
+    const char* arg = term.c_str() + op + 1;
+    char* end;
+    double val = strtod(arg, &end);
+    if (end == arg)
+        return false;
+    switch (term[op])
+    {
+    case '<':
+        predicate.lo = -inf;
+        predicate.hi = nextafter(val, -inf);
+        break;
+    case '>':
+        predicate.lo = nextafter(val, inf);
+        predicate.hi = inf;
+        break;
+    default:
+        predicate.lo = predicate.hi = val;
+        if (*end == ':')
+        {
+            arg = end + 1;
+            predicate.hi = strtod(arg, &end);
+            if (end == arg)
+                return false;
+        }
+        break;
+    }
+    while (*end == ' ')
+        end++;
+    return *end == '\0' && predicate.lo <= predicate.hi;
+}
+
+/**
+ * @brief Find the query's columns in an archive (the first archive bound
+ * also sets the output columns and precisions).
+ *
+ * @param reader The archive (opened).
+ * @param archiveFile The archive file (for error messages).
+ * @return True if the archive has every column tested by the predicates.
+*/
+bool BgArchiveQuery::Bind(BgArchiveReader& reader, string const& archiveFile)
+{
+    m_predicateCols.clear();
+    for (vector<BgQueryPredicate>::const_iterator it = m_predicates.begin(); it != m_predicates.end(); it++)
+    {
+        int col = reader.Column(it->heading);
+        if (col < 0)
+        {
+            cerr << "No " << it->heading << " column in " << archiveFile << endl;
+            return false;
+        }
+        m_predicateCols.push_back(col);
+    }
+
+    if (m_headers.empty())
+    {
+        if (m_select.empty())
+        {
+            for (size_t col = 0; col != reader.Columns(); col++)
+            {
+                if (!reader.Headers()[col].empty())
+                    m_select.push_back(reader.Headers()[col]);
+            }
+        }
+        for (vector<string>::const_iterator it = m_select.begin(); it != m_select.end(); it++)
+        {
+            int col = reader.Column(*it);
+            m_precisions.push_back((col < 0) ? 5 : reader.Precisions()[col]);
+        }
+        m_headers = m_select;
+        m_headers.push_back(string());
+        m_row.assign(m_select.size(), 0.0);
+        m_rowSeen.Resize(m_select.size());
+    }
+
+    // (A column that an archive doesn't have is written empty)
+    m_selectCols.clear();
+    for (vector<string>::const_iterator it = m_select.begin(); it != m_select.end(); it++)
+        m_selectCols.push_back(reader.Column(*it));
+    return true;
+}
+
+/**
+ * @brief Scan an archive (see Bind), writing the selected rows.
+ *
+ * @param reader The archive.
+ * @param writer The .csv file to which the selected rows are written.
+ * @return True if the whole archive was scanned.
+*/
+bool BgArchiveQuery::Run(BgArchiveReader& reader, BgCsvWriter& writer)
+{
+    vector<int> col(1);
+    size_t rows;
+    while (reader.NextBlock(rows))
+    {
+        m_scanned += rows;
+        m_selection.Resize(rows);
+        m_selection.SetAll();
+
+        // Apply the predicates in turn, decompressing each one's column,
+        // until every row of the block has been rejected
+        bool any = true;
+        m_predicateValues.resize(1);
+        for (size_t i = 0; any && i != m_predicates.size(); i++)
+        {
+            col[0] = m_predicateCols[i];
+            if (!reader.ReadColumns(col, m_predicateValues))
+                return false;
+            vector<uint64_t>& words = m_selection.Words();
+            Select(m_predicateValues[0].data(), rows, m_predicates[i], words.data());
+            any = false;
+            for (size_t w = 0; !any && w != words.size(); w++)
+                any = (words[w] != 0);
+        }
+        if (!any)
+            continue;
+
+        // Write the output columns of the selected rows
+        if (!reader.ReadColumns(m_selectCols, m_selectValues))
+            return false;
+        for (size_t row = m_selection.Next(0); row < rows; row = m_selection.Next(row + 1))
+        {
+            for (size_t c = 0; c != m_row.size(); c++)
+            {
+                m_row[c] = m_selectValues[c][row];
+                m_rowSeen.Assign(c, !std::isnan(m_row[c]));
+            }
+            writer.WriteObservations(m_row, m_precisions, m_rowSeen);
+            m_selected++;
+        }
+    }
+    return reader.Complete();
+}
+
+/// ///////////////////////////////////////////////////////////////////////////
+// Predicate kernels
+/// ///////////////////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Test one value (NaN, i.e. no value, never matches).
+*/
+template <bool ABS_VALUE>
+static inline bool Match(double val, double lo, double hi)
+{
+    double x = ABS_VALUE ? fabs(val) : val;
+    return x >= lo && x <= hi;
+}
+
+/**
+ * @brief Test 64 values, returning a bit for each (bit i = values[i] matches).
+*/
+template <bool ABS_VALUE>
+static inline uint64_t MatchWord(const double* values, double lo, double hi)
+{
+    uint64_t bits = 0;
+#if defined(BG_QUERY_SSE2)
+    // (The ordered comparisons are false for NaN)
+    const __m128d vlo = _mm_set1_pd(lo);
+    const __m128d vhi = _mm_set1_pd(hi);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    for (int i = 0; i != 64; i += 8)
+    {
+        unsigned mask = 0;
+        for (int j = 0; j != 8; j += 2)
+        {
+            __m128d x = _mm_loadu_pd(values + i + j);
+            if (ABS_VALUE)
+                x = _mm_andnot_pd(sign, x);
+            __m128d m = _mm_and_pd(_mm_cmpge_pd(x, vlo), _mm_cmple_pd(x, vhi));
+            mask |= static_cast<unsigned>(_mm_movemask_pd(m)) << j;
+        }
+        bits |= static_cast<uint64_t>(mask) << i;
+    }
+#elif defined(BG_QUERY_NEON)
+    const float64x2_t vlo = vdupq_n_f64(lo);
+    const float64x2_t vhi = vdupq_n_f64(hi);
+    for (int i = 0; i != 64; i += 2)
+    {
+        float64x2_t x = vld1q_f64(values + i);
+        if (ABS_VALUE)
+            x = vabsq_f64(x);
+        uint64x2_t m = vandq_u64(vcgeq_f64(x, vlo), vcleq_f64(x, vhi));
+        bits |= (vgetq_lane_u64(m, 0) & 1) << i;
+        bits |= (vgetq_lane_u64(m, 1) & 1) << (i + 1);
+    }
+#else
+    for (int i = 0; i != 64; i++)
+        bits |= static_cast<uint64_t>(Match<ABS_VALUE>(values[i], lo, hi)) << i;
+#endif
+    return bits;
+}
+
+template <bool ABS_VALUE>
+static void SelectRange(const double* values, size_t count, double lo, double hi, uint64_t* selection)
+{
+    size_t words = count / 64;
+    for (size_t w = 0; w != words; w++)
+    {
+        // (Skip the rows already rejected by an earlier predicate)
+        if (selection[w] != 0)
+            selection[w] &= MatchWord<ABS_VALUE>(values + w * 64, lo, hi);
+    }
+
+    size_t tail = count & 63;
+    if (tail != 0 && selection[words] != 0)
+    {
+        uint64_t bits = 0;
+        for (size_t i = 0; i != tail; i++)
+            bits |= static_cast<uint64_t>(Match<ABS_VALUE>(values[words * 64 + i], lo, hi)) << i;
+        selection[words] &= bits;
+    }
+}
+
+/**
+ * @brief Clear the selection bits of the rows that don't satisfy a predicate.
+ *
+ * @param values The values of the predicate's column (NaN = no value, which
+ *      never satisfies a predicate).
+ * @param count The number of values.
+ * @param predicate The predicate.
+ * @param selection The selection bitmap (bit i of word i / 64 for row i).
+*/
+void BgArchiveQuery::Select(const double* values, size_t count, BgQueryPredicate const& predicate, uint64_t* selection)
+{
+    if (predicate.absolute)
+        SelectRange<true>(values, count, predicate.lo, predicate.hi, selection);
+    else
+        SelectRange<false>(values, count, predicate.lo, predicate.hi, selection);
+}
+
+/**
+ * @brief The name of the predicate kernels compiled in.
+*/
+const char* BgArchiveQuery::Kernel()
+{
+#if defined(BG_QUERY_SSE2)
+    return "SSE2";
+#elif defined(BG_QUERY_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+#endif
@@ -0,0 +1,230 @@
+/**
+    bg-archive-reader-class.cpp
+
+    A class which reads back a columnar archive, a block at a time.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-archive-reader-class.h"
+#include "bg-archive-writer-class.h"
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace zlib = boost::beast::zlib;
+
+BgArchiveReader::BgArchiveReader() :
+    m_iFile(NULL), m_blockRows(0), m_blockEnd(-1), m_rowsInBlock(0), m_rows(0), m_recordedRows(0), m_complete(false)
+{
+}
+
+BgArchiveReader::~BgArchiveReader()
+{
+    if (m_iFile)
+        fclose(m_iFile);
+}
+
+/**
+ * @brief Open an archive, and read its header.
+ *
+ * @param filename The archive file.
+ * @return True if the file was opened (and is an archive).
+*/
+bool BgArchiveReader::Open(string const& filename)
+{
+    m_iFile = fopen(filename.c_str(), "rb");
+    if (m_iFile == NULL)
+    {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+
+    char magic[BG_ARCHIVE_MAGIC_LEN];
+    uint32_t fields[2];
+    if (fread(magic, 1, sizeof(magic), m_iFile) != sizeof(magic) ||
+        memcmp(magic, BG_ARCHIVE_MAGIC, sizeof(magic)) != 0 ||
+        fread(fields, sizeof(fields), 1, m_iFile) != 1)
+    {
+        cerr << "Not an archive file: " << filename << endl;
+        return false;
+    }
+
+    m_blockRows = fields[1];
+    for (uint32_t col = 0; col != fields[0]; col++)
+    {
+        string heading;
+        int c;
+        while ((c = fgetc(m_iFile)) != EOF && c != '\0')
+            heading += static_cast<char>(c);
+        c = fgetc(m_iFile);
+        if (c == EOF)
+        {
+            cerr << "Truncated archive header: " << filename << endl;
+            return false;
+        }
+        m_headers.push_back(heading);
+        m_precisions.push_back(static_cast<unsigned char>(c));
+    }
+    m_sizes.resize(m_headers.size());
+    m_offsets.resize(m_headers.size());
+    return true;
+}
+
+/**
+ * @brief Find a column by its heading.
+ *
+ * @return The (0-based) column, or -1 if there is no such column.
+*/
+int BgArchiveReader::Column(string const& heading) const
+{
+    for (size_t col = 0; col != m_headers.size(); col++)
+    {
+        if (m_headers[col] == heading)
+            return static_cast<int>(col);
+    }
+    return -1;
+}
+
+/**
+ * @brief Read the next block, decompressing only the columns asked for (the
+ * others are skipped).
+ *
+ * @param cols The (0-based) columns wanted.
+ * @param values Set to the values of each wanted column (values[i] is
+ *      column cols[i]; NaN where a row has no value).
+ * @param rows Set to the rows in the block.
+ * @return False at the end of the archive (see Complete), or on an error.
+*/
+bool BgArchiveReader::NextBlock(vector<int> const& cols, vector<vector<double> >& values, size_t& rows)
+{
+    return NextBlock(rows) && ReadColumns(cols, values);
+}
+
+/**
+ * @brief Move to the next block, reading just its directory (the columns
+ * are then read with ReadColumns).
+ *
+ * @param rows Set to the rows in the block.
+ * @return False at the end of the archive (see Complete), or on an error.
+*/
+bool BgArchiveReader::NextBlock(size_t& rows)
+{
+    rows = 0;
+    m_rowsInBlock = 0;
+    if (m_iFile == NULL || m_complete)
+        return false;
+    if (m_blockEnd >= 0 && fseek(m_iFile, m_blockEnd, SEEK_SET) != 0)
+        return false;
+
+    uint32_t blockRows;
+    if (fread(&blockRows, sizeof(blockRows), 1, m_iFile) != 1)
+        return false;
+    if (blockRows == 0)
+    {
+        m_complete = (fread(&m_recordedRows, sizeof(m_recordedRows), 1, m_iFile) == 1);
+        return false;
+    }
+    if (blockRows > m_blockRows ||
+        fread(m_sizes.data(), sizeof(uint32_t), m_sizes.size(), m_iFile) != m_sizes.size())
+        return false;
+
+    // Locate each column's bytes (they follow the directory, in column order)
+    long offset = ftell(m_iFile);
+    for (size_t col = 0; col != m_sizes.size(); col++)
+    {
+        m_offsets[col] = offset;
+        offset += m_sizes[col];
+    }
+    m_blockEnd = offset;
+
+    rows = m_rowsInBlock = blockRows;
+    m_rows += blockRows;
+    return true;
+}
+
+/**
+ * @brief Decompress columns of the current block (see NextBlock).
+ *
+ * @param cols The (0-based) columns wanted (-1 for a column that the archive
+ *      doesn't have).
+ * @param values Set to the values of each wanted column (values[i] is
+ *      column cols[i]; NaN where a row has no value).
+ * @return True if successful.
+*/
+bool BgArchiveReader::ReadColumns(vector<int> const& cols, vector<vector<double> >& values)
+{
+    if (m_rowsInBlock == 0)
+        return false;
+    values.resize(cols.size());
+    for (size_t i = 0; i != cols.size(); i++)
+    {
+        values[i].assign(m_rowsInBlock, numeric_limits<double>::quiet_NaN());
+        int col = cols[i];
+        if (col < 0 || static_cast<size_t>(col) >= m_sizes.size() || m_sizes[col] == 0)
+            continue;
+
+        // (A column asked for twice is decompressed once)
+        size_t first = find(cols.begin(), cols.end(), col) - cols.begin();
+        if (first != i)
+            values[i] = values[first];
+        else if (!Inflate(m_offsets[col], m_sizes[col], m_rowsInBlock, values[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Read and decompress one column of a block.
+ *
+ * @param offset The file offset of the column's bytes.
+ * @param bytes The compressed bytes.
+ * @param rows The rows in the block.
+ * @param values Set to the column's values.
+ * @return True if successful.
+*/
+bool BgArchiveReader::Inflate(long offset, size_t bytes, size_t rows, vector<double>& values)
+{
+    m_compressed.resize(bytes);
+    if (fseek(m_iFile, offset, SEEK_SET) != 0 || fread(&m_compressed[0], 1, bytes, m_iFile) != bytes)
+        return false;
+
+    // (The output has room to spare, so that the end of the stream is read
+    // before the output fills)
+    size_t bytesOut = rows * sizeof(double);
+    m_shuffled.resize(bytesOut + 16);
+    zlib::inflate_stream is;
+    is.reset(15);
+    zlib::z_params zs;
+    zs.next_in = m_compressed.data();
+    zs.avail_in = bytes;
+    zs.next_out = &m_shuffled[0];
+    zs.avail_out = m_shuffled.size();
+    boost::beast::error_code ec;
+
+    // (Beast's inflate_stream stops at block boundaries, asking for more
+    // buffers, so it is called until the end of the stream, or until it
+    // makes no more progress; it may not report the end of a short stream,
+    // so a column is complete once all its bytes are in and out)
+    size_t progress;
+    do
+    {
+        progress = zs.total_in + zs.total_out;
+        ec = {};
+        is.write(zs, zlib::Flush::none, ec);
+    } while ((!ec || ec == zlib::error::need_buffers) && zs.total_in + zs.total_out != progress);
+    bool complete = (ec == zlib::error::end_of_stream) || (zs.total_in == bytes && (!ec || ec == zlib::error::need_buffers));
+    if (!complete || zs.total_out != bytesOut)
+    {
+        cerr << "Decompression failed: " << (complete ? string("short column") : ec.message()) << endl;
+        return false;
+    }
+    BgArchiveWriter::Unshuffle(reinterpret_cast<const unsigned char*>(m_shuffled.data()), rows, values.data());
+    return true;
+}
@@ -0,0 +1,230 @@
+/**
+    bg-archive-writer-class.cpp
+
+    A class which writes CSV rows to a columnar, compressed archive.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-archive-writer-class.h"
+#include "bg-frame-file-class.h"
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace zlib = boost::beast::zlib;
+
+BgArchiveWriter::BgArchiveWriter() :
+    m_oFile(NULL), m_columns(0), m_blockRows(0), m_rows(0), m_bytes(0)
+{
+}
+
+BgArchiveWriter::~BgArchiveWriter()
+{
+    Close();
+}
+
+/**
+ * @brief Create an archive, and write its header.
+ *
+ * @param filename The archive file (any existing file is replaced).
+ * @param headers The column headings.
+ * @param precisions The digits written after the decimal point, for each
+ *      column (kept, so that the archive can be written out as .csv).
+ * @return True if the file was created.
+*/
+bool BgArchiveWriter::Open(string const& filename, vector<string> const& headers, vector<unsigned char> const& precisions)
+{
+    Close();
+    m_oFile = fopen(filename.c_str(), "wb");
+    if (m_oFile == NULL)
+    {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+
+    m_columns = headers.size();
+    m_block.assign(m_columns * BG_ARCHIVE_BLOCK_ROWS, numeric_limits<double>::quiet_NaN());
+    m_filled.assign(m_columns, 0);
+    m_sizes.resize(m_columns);
+    m_blockRows = 0;
+    m_rows = 0;
+
+    uint32_t fields[2] = { static_cast<uint32_t>(m_columns), BG_ARCHIVE_BLOCK_ROWS };
+    fwrite(BG_ARCHIVE_MAGIC, 1, BG_ARCHIVE_MAGIC_LEN, m_oFile);
+    fwrite(fields, sizeof(fields), 1, m_oFile);
+    m_bytes = BG_ARCHIVE_MAGIC_LEN + sizeof(fields);
+    for (size_t col = 0; col != m_columns; col++)
+    {
+        unsigned char precision = (col < precisions.size()) ? precisions[col] : 0;
+        fwrite(headers[col].c_str(), 1, headers[col].size() + 1, m_oFile);
+        fwrite(&precision, 1, 1, m_oFile);
+        m_bytes += headers[col].size() + 2;
+    }
+    return true;
+}
+
+/**
+ * @brief Add a row (the columns flagged in 'seen' have values).
+ *
+ * @param values The value of each column.
+ * @param seen The columns that have values.
+*/
+void BgArchiveWriter::WriteRow(vector<double> const& values, BgColumnBitset const& seen)
+{
+    if (m_oFile == NULL)
+        return;
+    size_t columns = min(values.size(), m_columns);
+    for (size_t col = seen.Next(0); col < columns; col = seen.Next(col + 1))
+    {
+        m_block[col * BG_ARCHIVE_BLOCK_ROWS + m_blockRows] = values[col];
+        m_filled[col] = 1;
+    }
+    if (++m_blockRows == BG_ARCHIVE_BLOCK_ROWS)
+        WriteBlock();
+}
+
+/**
+ * @brief Add a row (NaN where a column has no value).
+ *
+ * @param values The value of each column.
+*/
+void BgArchiveWriter::WriteRow(vector<double> const& values)
+{
+    if (m_oFile == NULL)
+        return;
+    size_t columns = min(values.size(), m_columns);
+    for (size_t col = 0; col != columns; col++)
+    {
+        if (!std::isnan(values[col]))
+        {
+            m_block[col * BG_ARCHIVE_BLOCK_ROWS + m_blockRows] = values[col];
+            m_filled[col] = 1;
+        }
+    }
+    if (++m_blockRows == BG_ARCHIVE_BLOCK_ROWS)
+        WriteBlock();
+}
+
+/**
+ * @brief Write the last block and the end marker, and close the file.
+ *
+ * @return True if everything was written.
+*/
+bool BgArchiveWriter::Close()
+{
+    if (m_oFile == NULL)
+        return false;
+    if (m_blockRows != 0)
+        WriteBlock();
+
+    uint32_t end = 0;
+    fwrite(&end, sizeof(end), 1, m_oFile);
+    fwrite(&m_rows, sizeof(m_rows), 1, m_oFile);
+    m_bytes += sizeof(end) + sizeof(m_rows);
+    bool ok = !ferror(m_oFile);
+    ok = (fclose(m_oFile) == 0) && ok;
+    m_oFile = NULL;
+    return ok;
+}
+
+/**
+ * @brief Compress and write the rows of the block, column by column, and
+ * start a new block.
+*/
+void BgArchiveWriter::WriteBlock()
+{
+    // Compress each column that has values (the directory of sizes is
+    // written first, so a reader can skip the columns it doesn't need)
+    vector<string> payloads(m_columns);
+    size_t bytes = m_blockRows * sizeof(double);
+    for (size_t col = 0; col != m_columns; col++)
+    {
+        m_sizes[col] = 0;
+        if (!m_filled[col])
+            continue;
+
+        double* values = &m_block[col * BG_ARCHIVE_BLOCK_ROWS];
+        m_shuffled.resize(bytes);
+        Shuffle(values, m_blockRows, reinterpret_cast<unsigned char*>(&m_shuffled[0]));
+
+        zlib::deflate_stream ds;
+        ds.reset(DEFAULT_COMPRESSION_LEVEL, 15, 8, zlib::Strategy::normal);
+        m_compressed.resize(ds.upper_bound(bytes));
+        zlib::z_params zs;
+        zs.next_in = m_shuffled.data();
+        zs.avail_in = bytes;
+        zs.next_out = &m_compressed[0];
+        zs.avail_out = m_compressed.size();
+        boost::beast::error_code ec;
+        ds.write(zs, zlib::Flush::finish, ec);
+        if (ec != zlib::error::end_of_stream)
+        {
+            cerr << "Compression failed: " << ec.message() << endl;
+            continue;
+        }
+        payloads[col].assign(m_compressed.data(), zs.total_out);
+        m_sizes[col] = static_cast<uint32_t>(zs.total_out);
+
+        // (Empty the column for the next block)
+        for (size_t row = 0; row != m_blockRows; row++)
+            values[row] = numeric_limits<double>::quiet_NaN();
+        m_filled[col] = 0;
+    }
+
+    uint32_t rows = static_cast<uint32_t>(m_blockRows);
+    fwrite(&rows, sizeof(rows), 1, m_oFile);
+    fwrite(m_sizes.data(), sizeof(uint32_t), m_columns, m_oFile);
+    m_bytes += sizeof(rows) + sizeof(uint32_t) * m_columns;
+    for (size_t col = 0; col != m_columns; col++)
+    {
+        fwrite(payloads[col].data(), 1, payloads[col].size(), m_oFile);
+        m_bytes += payloads[col].size();
+    }
+
+    m_rows += m_blockRows;
+    m_blockRows = 0;
+}
+
+/**
+ * @brief Byte-shuffle values: the first byte of each, then the second, etc.
+ * (The sign, exponent and leading mantissa bytes of a column's values
+ * change slowly, so they compress much better when grouped together.)
+ *
+ * @param values The values.
+ * @param count The number of values.
+ * @param bytes Set to the shuffled bytes (count * 8).
+*/
+void BgArchiveWriter::Shuffle(const double* values, size_t count, unsigned char* bytes)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(values);
+    for (size_t b = 0; b != sizeof(double); b++)
+    {
+        for (size_t i = 0; i != count; i++)
+            bytes[b * count + i] = in[i * sizeof(double) + b];
+    }
+}
+
+/**
+ * @brief Reverse Shuffle.
+ *
+ * @param bytes The shuffled bytes (count * 8).
+ * @param count The number of values.
+ * @param values Set to the values.
+*/
+void BgArchiveWriter::Unshuffle(const unsigned char* bytes, size_t count, double* values)
+{
+    unsigned char* out = reinterpret_cast<unsigned char*>(values);
+    for (size_t b = 0; b != sizeof(double); b++)
+    {
+        for (size_t i = 0; i != count; i++)
+            out[i * sizeof(double) + b] = bytes[b * count + i];
+    }
+}
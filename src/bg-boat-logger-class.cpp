@@ -0,0 +1,873 @@
+/**
+    bg-boat-logger-class.cpp
+
+    A class which logs the data from one boat's H5000 CPU.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-boat-logger-class.h"
+#include "h5000-logger-class.h"
+#include <cmath>
+#include <iomanip>
+
+/// ///////////////////////////////////////////////////////////////////////////
+// Public Member Functions
+/// ///////////////////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Constructor.
+ *
+ * Create the boat's output writers (as selected on the command line) and
+ * size its observation vectors. The data item definitions must already be
+ * loaded.
+ *
+ * @param app The application (supplies options, io_context and data definitions).
+ * @param boat The boat index (written to the "Boat" column of the CSV file).
+ * @param host The H5000 CPU's websocket host ("" when processing a flat log file).
+ * @param port The H5000 CPU's websocket port.
+ * @param outDir The directory in which to write this boat's output files.
+*/
+BgBoatLogger::BgBoatLogger(H5000Logger& app, int boat, string const& host, string const& port, string const& outDir) :
+    m_app(app), m_boat(boat), m_host(host), m_port(port), m_outDir(outDir),
+    m_debugFlag(app.m_debugFlag), m_testFlag(app.m_testFlag), m_csvFlag(app.m_csvFlag),
+    m_flatFlag(app.m_flatFlag), m_csvWriter(NULL), m_flatWriter(NULL), m_sparseWriter(NULL), m_captureWriter(NULL),
+    m_rollupWriter(NULL), m_archiveWriter(NULL), m_archivedRows(0), m_archivedUtcSum(0),
+    m_maneuverDetector(NULL), m_windCalibrator(NULL),
+    m_speedCalibrator(NULL), m_logStrand(net::make_strand(app.m_ioc)), m_statsTimer(app.m_ioc), m_rowTimer(app.m_ioc),
+    m_nextFrameSeq(0), m_nextDeliverSeq(0), m_dataDefs(app.m_dataDefs),
+    m_rawTimestamp(0), m_rawDatestamp(0), m_timestampSeen(false), m_fileDate(0), m_rowInterval(host.empty() ? chrono::milliseconds(0) : app.m_rowInterval),
+    m_rowAlignGps(app.m_rowAlignGps), m_rowUtc(0), m_gpsTime(-1), m_firstObservation(true),
+    m_socketBacklog(0)
+{
+    m_label = "boat " + to_string(m_boat);
+    if (!m_host.empty())
+        m_label += " (" + m_host + ":" + m_port + ")";
+
+    if (m_csvFlag && app.m_sparseFlag)
+        m_sparseWriter = new BgSparseWriter(m_outDir);
+    else if (m_csvFlag)
+        m_csvWriter = new BgCsvWriter(m_outDir, app.m_fileOptions);
+    if (m_flatFlag)
+    {
+        m_flatWriter = new BgFlatWriter(m_outDir, app.m_fileOptions);
+        m_flatWriter->SetDeadbands(app.m_dataDefs.Deadbands());
+    }
+
+    // Identify the columns used to timestamp each row (checked by H5000Logger::LoadDataDefs)
+    m_colDate = m_dataDefs.CsvColumn(34);
+    m_colTime = m_dataDefs.CsvColumn(35);
+    m_colUtc = m_dataDefs.CsvColumn("Utc");
+    m_colBoat = m_dataDefs.CsvColumn("Boat");
+
+    // (The UTC date and time are always carried forward to the next row)
+    m_row.Init(m_dataDefs, { m_colDate, m_colTime });
+
+    if (app.m_rollupFlag)
+        m_rollupWriter = new BgRollupWriter(m_outDir, m_dataDefs, m_boat, { m_colDate, m_colTime, m_colUtc, m_colBoat },
+            app.m_fileOptions);
+
+    if (app.m_maneuverFlag)
+        m_maneuverDetector = new BgManeuverDetector(m_outDir, m_boat, app.m_fileOptions);
+    if (app.m_windCalibrationFlag)
+        m_windCalibrator = new BgWindCalibrator(m_outDir, m_boat);
+    if (app.m_speedCalibrationFlag)
+        m_speedCalibrator = new BgSpeedCalibrator(m_outDir, m_boat);
+
+    m_priorityFilter.Init(m_dataDefs, app.m_priorityRates);
+}
+
+/**
+ * @brief Destructor: close the output files (waiting for any compressed
+ * frames still queued to be written).
+*/
+BgBoatLogger::~BgBoatLogger()
+{
+    delete m_csvWriter;
+    delete m_flatWriter;
+    delete m_sparseWriter;
+    delete m_captureWriter;
+    delete m_rollupWriter;
+
+    // (The last maneuver is completed with what was observed of its post window)
+    if (m_maneuverDetector && m_maneuverDetector->Flush() && m_windCalibrator)
+        m_windCalibrator->AddManeuver(m_maneuverDetector->LastManeuver());
+    delete m_maneuverDetector;
+    delete m_windCalibrator;
+    delete m_speedCalibrator;
+}
+
+/**
+ * @brief Connect to the boat's H5000 CPU and start logging.
+ *
+ * The websocket session runs on the application's io_context, so this
+ * function returns immediately.
+*/
+void BgBoatLogger::Start()
+{
+    // Capture the raw frames received (if desired)
+    if (m_app.m_captureFlag)
+    {
+        m_captureWriter = new BgCaptureWriter(m_outDir);
+        if (m_captureWriter->Open())
+            DEBUGOUT("Capturing " << m_label << " to " << m_captureWriter->FileName())
+    }
+
+    // Create the websocket session (with a bounded outgoing message queue)
+    m_session = make_shared<BgWebsocketSession>(this, m_app.m_ioc, m_debugFlag, m_testFlag);
+    m_session->SetQueueLimit(m_app.m_queueLimit, m_app.m_queuePolicy);
+    if (m_app.m_deflateFlag)
+        m_session->SetDeflate(m_app.m_deflateWindowBits, m_app.m_deflateMemLevel);
+    m_session->run(m_host.c_str(), m_port.c_str());
+
+    // Report statistics periodically (if desired)
+    if (m_app.m_statsInterval > 0)
+        ScheduleStats();
+
+    // Write CSV rows on a timer (if desired)
+    if (m_rowInterval.count() > 0)
+        ScheduleRow();
+}
+
+/**
+ * @brief Process a captured frame, as if it had just been received.
+ *
+ * Used to replay a capture file (-y); the replay must be single-threaded
+ * (the application's io_context isn't running).
+ *
+ * @param s The frame text.
+ * @param monotonicNs The steady clock when the frame was captured (ns).
+ * @param realtimeNs The system clock when the frame was captured (ns since 1970).
+*/
+void BgBoatLogger::ReplayFrame(string const& s, uint64_t monotonicNs, int64_t realtimeNs)
+{
+    handleResponse(s, monotonicNs, realtimeNs);
+}
+
+#endif
+
+
+/// ///////////////////////////////////////////////////////////////////////////
+// Outgoing websocket message constructors
+/// ///////////////////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Request all (relevant) values from the H5000 CPU.
+ *
+ * This function is called when the websocket handshake is successfully
+ * completed to start the stream of data values coming from the websocket
+ * server. All of the ids are coalesced into as few "DataInfoReq"/"DataReq"
+ * messages as the CPU accepts, and the messages are queued for sending
+ * back-to-back.
+ *
+ * @see on_handshake()
+*/
+void BgBoatLogger::RequestAllValues() {
+
+    // todo Remove hardwired value ids and replace with those "advertised" by the CPU.
+    // todo Periodically request a list of "advertised" value from the CPU (e.g., if new devices have appeared)
+
+    DEBUGOUT("Requesting dataitem info and values from " << m_label << ".")
+
+    BgSubscriptionBuilder subscription(m_app.m_itemsPerFrame);
+    subscription.Add({ 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 17, 18, 19, 21, 23, 27, 30, 31, 32, 33, 34, 35, 37, 39, 40, 41, 42, 44, 45, 46 });
+    subscription.Add({ 47, 48, 49, 65, 66, 77, 118, 119, 121, 122, 125, 140, 141, 142, 146, 150, 157, 165, 217, 218, 219, 220, 221, 222, 223, 224, 225, 226, 227, 228, 230, 231, 232 });
+    subscription.Add({ 233, 234, 235, 236, 238, 240, 241, 243, 304, 305, 306, 309, 310, 311, 312, 313, 314, 315, 316, 317, 318, 319, 320, 321, 322, 323, 324, 325, 326, 327 });
+    subscription.Add({ 328, 329, 330, 331, 332, 333, 334, 335, 336, 337, 338, 339, 340, 341, 342, 343, 344, 345, 346, 347, 348, 349, 350, 351, 352, 353, 354, 355, 356, 357 });
+    subscription.Add({ 358, 359, 360, 361, 362, 363, 364, 365, 366, 367, 368, 369, 370, 371, 372, 373, 374, 375, 376, 377, 378, 379, 380, 381, 382, 383, 384, 385, 386, 387, 388 });
+    subscription.Add({ 389, 390, 391, 392, 393, 394, 395, 396, 397, 398, 399, 400, 401, 402, 403, 404, 405, 406, 407, 408, 409, 410, 411, 412, 413, 414, 415, 416, 417, 418, 419 });
+    subscription.Add({ 420, 421, 422, 423, 424, 425, 426, 427, 428, 429, 432, 433, 434, 435, 436, 437, 438, 439, 440, 441, 442, 443, 444, 445, 446, 447, 448, 449, 450, 451, 452, 453 });
+    subscription.Add({ 454, 455, 456, 457, 458, 459, 460, 461, 462, 463, 464, 465, 466, 467, 468, 469, 470, 471, 472, 473, 474, 475, 476, 477, 478, 479, 480, 481, 482, 483, 484, 485 });
+    subscription.Add({ 486, 487, 488, 489, 490, 491, 492, 493, 494, 495, 496, 497, 498, 499, 500, 501, 502, 503, 504, 505, 506, 507, 508, 509, 510, 511, 512, 513, 514, 515 });
+
+    // Request every instance of the items logged for more than one instance
+    vector<int> const& multi = m_dataDefs.MultiInstanceIds();
+    for (vector<int>::const_iterator it = multi.begin(); it != multi.end(); it++)
+        subscription.Add(*it, m_dataDefs.Instances(*it));
+
+    // Just ask for one "batch" of values if in test mode
+    vector<shared_ptr<string const> > frames = subscription.Frames(m_testFlag);
+    DEBUGOUT("Subscribing to " << subscription.Size() << " data items in " << frames.size() << " messages.")
+    if (frames.size() > m_session->QueueLimit())
+        cerr << "Warning: " << frames.size() << " subscription messages exceed the outgoing queue limit ("
+            << m_session->QueueLimit() << "); some will not be sent" << endl;
+    m_session->send(frames);
+}
+
+#endif
+
+/// //////////////////////////////////////////////////////////////
+// Incoming websocket message handlers
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+/**
+ * @brief Handles an incoming message by converting it to JSON, then calling the handler.
+ *
+ * This function is called on the session's strand. With a single I/O thread
+ * the message is parsed and processed immediately. With more threads, the
+ * (comparatively expensive) parsing is posted to the io_context's thread
+ * pool and the resulting observations are processed on the boat's logging
+ * strand, in the order the messages were received.
+ *
+ * @param s A incoming message string.
+ * @param monotonicNs The steady clock when the message was received (ns).
+ * @param realtimeNs The system clock when the message was received (ns since 1970).
+*/
+void BgBoatLogger::handleResponse(string const& s, uint64_t monotonicNs, int64_t realtimeNs)
+{
+    // If we're in "test" mode, we're done--the response has already been displayed
+    if (m_testFlag) {
+        DEBUGOUT("Test complete.")
+        exit(0);
+    }
+
+    if (m_app.m_threads <= 1)
+    {
+        vector<BgObservation> observations;
+        int shedLevel = UpdateShedLevel(monotonicNs);
+        Json::Value root = ConstructJson(s);
+        handleResponse(root, observations, shedLevel);
+        StampObservations(observations, monotonicNs, realtimeNs);
+        HandleObservations(observations);
+        return;
+    }
+
+    // Parse on any worker thread, then hand the observations to the logging strand
+    uint64_t seq = m_nextFrameSeq++;
+    shared_ptr<string> frame = make_shared<string>(s);
+    net::post(m_app.m_ioc, [this, seq, frame, monotonicNs, realtimeNs]()
+    {
+        shared_ptr<vector<BgObservation> > observations = make_shared<vector<BgObservation> >();
+        int shedLevel = UpdateShedLevel(monotonicNs);
+        Json::Value root = ConstructJson(*frame);
+        handleResponse(root, *observations, shedLevel);
+        StampObservations(*observations, monotonicNs, realtimeNs);
+        net::post(m_logStrand, [this, seq, observations]()
+        {
+            DeliverObservations(seq, observations);
+        });
+    });
+}
+
+/**
+ * @brief Decide how much to shed from a message about to be parsed (see
+ * BgPriorityFilter), from how long it has waited since it was received, and
+ * what is still waiting on the socket.
+ *
+ * Called on the session's strand, or a worker thread, before the message
+ * is parsed. Nothing is shed when replaying.
+ *
+ * @param monotonicNs The steady clock when the message was received (ns).
+ * @return The BgShedLevel.
+*/
+int BgBoatLogger::UpdateShedLevel(uint64_t monotonicNs)
+{
+    if (!m_session || monotonicNs == 0)
+        return SHED_NONE;
+    int64_t now = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t lag = now - static_cast<int64_t>(monotonicNs);
+    size_t backlog = m_socketBacklog.load(memory_order_relaxed);
+    int lastLevel = m_priorityFilter.ShedLevel();
+    int shedLevel = m_priorityFilter.UpdateShedLevel(lag, backlog, now);
+    if (shedLevel != lastLevel)
+    {
+        static const char* SHED_MESSAGES[] = { "all items processed", "shedding housekeeping items",
+            "shedding normal and housekeeping items" };
+        cout << "Ingest for " << m_label << ": " << SHED_MESSAGES[shedLevel] << " ("
+            << fixed << setprecision(1) << lag / 1e6 << " ms behind, " << backlog / 1024 << " KB waiting)"
+            << defaultfloat << endl;
+    }
+    return shedLevel;
+}
+
+/**
+ * @brief Stamp the observations parsed from a message with its receive time.
+ *
+ * @param observations The observations.
+ * @param monotonicNs The steady clock when the message was received (ns).
+ * @param realtimeNs The system clock when the message was received (ns since 1970).
+*/
+void BgBoatLogger::StampObservations(vector<BgObservation>& observations, uint64_t monotonicNs, int64_t realtimeNs)
+{
+    for (vector<BgObservation>::iterator it = observations.begin(); it != observations.end(); it++)
+        it->setReceived(monotonicNs, realtimeNs);
+}
+
+/**
+ * @brief Process the observations parsed from a message, in message order.
+ *
+ * Called on the logging strand. Messages parsed out of order (by different
+ * worker threads) are held until all earlier messages have been processed,
+ * so the observations of each data item are always processed in the order
+ * they were received.
+ *
+ * @param seq The sequence number of the message (in order of receipt).
+ * @param observations The valid observations parsed from the message.
+*/
+void BgBoatLogger::DeliverObservations(uint64_t seq, shared_ptr<vector<BgObservation> > observations)
+{
+    m_pendingFrames[seq] = observations;
+    while (!m_pendingFrames.empty() && m_pendingFrames.begin()->first == m_nextDeliverSeq)
+    {
+        HandleObservations(*m_pendingFrames.begin()->second);
+        m_pendingFrames.erase(m_pendingFrames.begin());
+        m_nextDeliverSeq++;
+    }
+}
+
+/**
+ * @brief Process incoming JSON message.
+ *
+ * At this point, the program only "handles" "Data" and "Many" messages,
+ * although the B&G websocket server can send many other types.
+ *
+ * Based on the type of message, a handleXXX function is called to process the
+ * specific message type.
+ *
+ * @param root_ A JSON value representing the message to be handled.
+ * @param observations Valid observations in the message are appended to this vector.
+ * @param shedLevel The BgShedLevel (the items to drop).
+ * @see handleResponse(string&)
+*/
+void BgBoatLogger::handleResponse(Json::Value& root_, vector<BgObservation>& observations, int shedLevel)
+{
+    if (root_.isMember("Data") != Json::nullValue) {
+        handleData(root_["Data"], observations, shedLevel);
+    }
+    if (root_.isMember("Many") != Json::nullValue) {
+        handleData(root_["Many"], observations, shedLevel);
+    }
+
+}
+
+/**
+ * @brief Handle a "Data" JSON message.
+ *
+ * This function creates an Observation object for each data id in the message
+ * (there can be more than one) that is not being shed, and collects the valid
+ * ones, to be added to the log output stream(s).
+ *
+ * @param root_ The root of the "Data" JSON message object.
+ * @param observations Valid observations in the message are appended to this vector.
+ * @param shedLevel The BgShedLevel (the items to drop).
+*/
+void BgBoatLogger::handleData(Json::Value& root_, vector<BgObservation>& observations, int shedLevel)
+{
+    for (Json::Value::ArrayIndex idx = 0; idx != root_.size(); idx++) {
+
+        // Drop the lower priority items while the logger is behind (by id alone)
+        Json::Value const& item = root_[idx];
+        if (m_priorityFilter.Shed(item["id"].asInt(), shedLevel))
+            continue;
+
+        // Construct a BgObservation object from the JSON data
+        BgObservation o(item);
+
+        // Keep the data if the value is valid
+        if (o.isValid())
+            observations.push_back(o);
+    }
+}
+
+/**
+ * @brief Add a set of valid observations to the log output stream(s).
+ *
+ * @param observations The observations, in the order received.
+*/
+void BgBoatLogger::HandleObservations(vector<BgObservation>& observations)
+{
+    for (vector<BgObservation>::iterator it = observations.begin(); it != observations.end(); it++)
+    {
+        // Report the time from process start to the first observation
+        // (and from the websocket handshake to the first data; not when replaying)
+        if (m_firstObservation && m_session)
+        {
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            chrono::duration<double, milli> elapsed = now - m_app.m_startTime;
+            chrono::duration<double, milli> handshake = now - m_session->HandshakeTime();
+            cout << "Time to first observation from " << m_label << ": " << fixed << setprecision(1)
+                << elapsed.count() << " ms (" << handshake.count() << " ms after handshake)" << defaultfloat << endl;
+            m_firstObservation = false;
+        }
+        if (m_priorityFilter.Admit(*it))
+            ProcessObservation(*it);
+    }
+}
+
+#endif
+
+/// //////////////////////////////////////////////////////////////
+// Aggregation of observations
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Add a single observation to the boat's current row (and flat log).
+ *
+ * @param o The observation.
+*/
+void BgBoatLogger::ProcessObservation(BgObservation& o)
+{
+
+    // Select the handling code corresponding to the data id (only instance 0
+    // of the UTC date and time is used for timestamping)
+    switch (o.getInst() == 0 ? o.getId() : -1) {
+
+    case 34:		// UTC (date)
+    {
+        // Convert the date from Julian Date to an Excel-compatible date (days since Jan 0, 1900)
+        m_row.Set(m_colDate, o.getVal() - 2415019, Now());
+        unsigned long int utcdate = static_cast<int>(m_row.Value(m_colDate));
+
+        // Test to see if this is the first "datestamp" observed
+        if (!m_timestampSeen)
+        {
+            // Test to see if a timestamp has been observed yet
+            if (m_row.Seen(m_colTime))
+            {
+                // OK. We've just observed the first datestamp and have
+                // received a timestamp, so start a new output file for the
+                // new date
+                m_rawTimestamp = static_cast<uint64_t>(m_row.Value(m_colTime));
+                m_rawDatestamp = utcdate;
+                NewDate(utcdate);
+                m_timestampSeen = true;
+            }
+        }
+        else {
+            // Test to see if the UTC Date has rolled over to the next day
+            // (the row being collected belongs to the new day, so it is kept)
+            if (utcdate != m_fileDate) {
+                OpenFiles(utcdate);
+            }
+        }
+
+        break;
+    }
+
+    case 35:		// UTC (time)
+    {
+        m_row.Set(m_colTime, o.getVal(), Now());
+        unsigned long int utctime = static_cast<int>(m_row.Value(m_colTime));
+
+        // Keep the GPS clock reference for timer-driven rows
+        if (m_rowInterval.count() > 0)
+        {
+            m_gpsTime = o.getVal();
+            m_gpsTimeAt = chrono::steady_clock::now();
+        }
+
+        // Test to see if this is the first "timestamp" observed
+        if (!m_timestampSeen)
+        {
+            // Test to see if a 'datestamp' has been observed yet
+            unsigned long int utcdate = static_cast<int>(m_row.Value(m_colDate));
+            if (m_row.Seen(m_colDate))
+            {
+                // OK. We've just observed the first timestamp and have
+                // previously seen a 'datestamp,' so start a new output file
+                // for the new date
+                NewDate(utcdate);
+
+                // Set the rawTimestamp
+                m_rawTimestamp = static_cast<uint64_t>(o.getVal());
+                m_rawDatestamp = utcdate;
+                m_timestampSeen = true;
+            }
+        }
+        else if (m_rowInterval.count() == 0)
+        {
+            // The time goes back at midnight: the row it starts belongs to
+            // the new day, even if the new date hasn't been received yet
+            if (m_rawTimestamp - o.getVal() > 12 * 60 * 60)
+                RollDate();
+
+            // Test to see if this time is within 2 seconds of the current stamp
+            // (or has gone back)
+            if (o.getVal() - m_rawTimestamp > 1.5 || o.getVal() < m_rawTimestamp)
+            {
+                NewTime(utctime);
+            }
+        }
+        break;
+    }
+
+    default:
+    {
+        // Record the value if the item (and instance) is tracked in the CSV file
+        int col = m_dataDefs.CsvColumn(o.getId(), o.getInst());
+        if (col < 0)
+            break;
+        double now = Now();
+        m_row.Set(col, o.getVal(), now);
+
+        // Update the item's statistics columns (if any)
+        int count;
+        int stat = m_dataDefs.StatsColumns(o.getId(), o.getInst(), count);
+        for (int i = 0; i != count; i++)
+            m_row.Set(stat + i, o.getVal(), now);
+        break;
+    }
+    }
+
+    // Write all observations to the flat file (if desired)
+    if (m_flatFlag)
+    {
+        m_flatWriter->ProcessObservation(o);
+    }
+
+    // Follow the boat's tacks and gybes (if desired; once the date is known)
+    if (m_maneuverDetector && m_fileDate != 0 && o.getInst() == 0)
+    {
+        double utcDateTime = m_row.Value(m_colDate) + (m_row.Value(m_colTime) / (24.0 * 60.0 * 60.0));
+        double now = Now();
+        if (m_maneuverDetector->Observe(o.getId(), o.getVal(), now, utcDateTime) && m_windCalibrator)
+            m_windCalibrator->AddManeuver(m_maneuverDetector->LastManeuver());
+
+        // (The maneuver is added before the report is rewritten)
+        if (m_windCalibrator)
+            m_windCalibrator->Tick(now);
+    }
+
+    // Compare the boat speed with the GPS (if desired; once the date is known)
+    if (m_speedCalibrator && m_fileDate != 0 && o.getInst() == 0 && o.isValid())
+        m_speedCalibrator->Observe(o.getId(), o.getVal(), Now());
+
+}
+
+
+/**
+ * @brief Start a new .csv file and re-initialize the collection of observations.
+ *
+ * @param utcdate_ An integer representation of the number of days since Jan 0, 1900.
+*/
+void BgBoatLogger::NewDate(unsigned long int utcdate)
+{
+    // Write the accumulated information for the most recent timestamp to
+    // the .csv file, then close it (if the file was open in the first place)
+    if (m_csvFlag || m_archiveWriter)
+    {
+        // Write current observation list to the file
+        m_row.Expire(Now());
+        OutputRow();
+    }
+    RollupRow(m_row.Value(m_colUtc));
+    OpenFiles(utcdate);
+
+
+    // Clear the stored observations (and zero the time)
+    Clear();
+    m_row.SetSeen(m_colTime, false);
+}
+
+/**
+ * @brief Start the output files for a date (closing the previous date's files).
+ *
+ * @param utcdate An integer representation of the number of days since Jan 0, 1900.
+*/
+void BgBoatLogger::OpenFiles(unsigned long int utcdate)
+{
+    if (m_csvFlag)
+    {
+        if (m_sparseWriter)
+            m_sparseWriter->NewFile(utcdate, m_dataDefs.Headers(), m_dataDefs.Precisions());
+        else
+            m_csvWriter->NewFile(utcdate, m_dataDefs.Headers());
+    }
+
+    if (m_flatFlag)
+    {
+        m_flatWriter->NewFile(utcdate);
+    }
+
+    if (m_rollupWriter)
+        m_rollupWriter->NewFile(utcdate);
+    if (m_maneuverDetector)
+        m_maneuverDetector->NewFile(utcdate);
+    if (m_windCalibrator)
+        m_windCalibrator->NewFile(utcdate);
+    if (m_speedCalibrator)
+        m_speedCalibrator->NewFile(utcdate);
+    m_fileDate = utcdate;
+}
+
+/**
+ * @brief Move to the next day when the time has gone back at midnight (if
+ * the new date hasn't already been received), so that the row the time
+ * starts is dated, and written to the files of, the new day.
+*/
+void BgBoatLogger::RollDate()
+{
+    if (static_cast<unsigned long int>(m_row.Value(m_colDate)) != m_rawDatestamp)
+        return;
+    m_row.Set(m_colDate, m_row.Value(m_colDate) + 1, Now());
+    OpenFiles(m_fileDate + 1);
+}
+
+/**
+ * @brief Write the accumulated observations for the old timestamp to the file.
+ *
+ * When a new timestamp is observed, the existing observations are written to
+ * the .csv output file (identified with the old timestamp), the tracked data
+ * values are cleared, and a new collection of observations is started.
+ *
+ * @param utctime_ An integer representation of the number of seconds since midnight UTC.
+*/
+void BgBoatLogger::NewTime(unsigned long int utctime)
+{
+    // Create an Excel-compatible "Utc" field
+    double UtcDateTime = m_row.Value(m_colDate) + (m_row.Value(m_colTime) / (24.0 * 60.0 * 60.0));
+    if (!m_archiveWriter)
+        cout << "TS:  " << setprecision(10) << UtcDateTime << " (boat " << m_boat << ")" << endl;
+    WriteRow(UtcDateTime);
+
+    // Clear the stored observations (except date and time)
+    Clear();
+    m_row.Values()[m_colTime] = utctime;
+
+    // Set raw timestamp value (and the date it is on)
+    m_rawTimestamp = utctime;
+    m_rawDatestamp = static_cast<unsigned long int>(m_row.Value(m_colDate));
+}
+
+/**
+ * @brief Write the accumulated observations to the .csv file as one row.
+ *
+ * @param utcDateTime The Excel-compatible date and time of the row (written
+ *      to the "Utc" column; the "Boat" column is populated with the boat index).
+*/
+void BgBoatLogger::WriteRow(double utcDateTime)
+{
+    double now = Now();
+    m_row.Set(m_colUtc, utcDateTime, now);
+    m_row.Set(m_colBoat, m_boat, now);
+
+    if (m_csvFlag || m_archiveWriter) {
+        m_row.Expire(now);
+        OutputRow();
+    }
+    RollupRow(utcDateTime);
+}
+
+/**
+ * @brief Add the accumulated observations to the 10 s and 1 min summaries (with -R).
+ *
+ * @param utcDateTime The Excel-compatible date and time of the row.
+*/
+void BgBoatLogger::RollupRow(double utcDateTime)
+{
+    if (m_rollupWriter && m_fileDate != 0)
+        m_rollupWriter->AddRow(utcDateTime, m_row.Values(), m_row.UpdatedFlags());
+}
+
+/**
+ * @brief Write the accumulated row to the .csv file (or to the sparse file,
+ * with -x, or to the archive, when converting with -C).
+*/
+void BgBoatLogger::OutputRow()
+{
+    if (m_archiveWriter)
+    {
+        // (Rows before the first date are not written, as for the .csv file)
+        if (m_fileDate != 0)
+        {
+            m_archiveWriter->WriteRow(m_row.Values(), m_row.SeenFlags());
+            m_archivedRows++;
+            if (m_row.Seen(m_colUtc))
+                m_archivedUtcSum += m_row.Value(m_colUtc);
+        }
+    }
+    else if (m_sparseWriter)
+        m_sparseWriter->WriteObservations(m_row.Value(m_colUtc), m_row.Values(), m_row.SeenFlags());
+    else
+        m_csvWriter->WriteObservations(m_row.Values(), m_dataDefs.Precisions(), m_row.SeenFlags());
+}
+
+/**
+ * @brief Clear accumulated observation data from the object.
+ *
+ * This function is called immediately after a timestamp set of values has been
+ * written to the .csv file. Each column is then cleared, held or restarted,
+ * according to its policy (the date and time are always held).
+*/
+void BgBoatLogger::Clear()
+{
+    m_row.EndRow();
+}
+
+/**
+ * @brief The clock against which held values are aged (seconds).
+ *
+ * Live, this is the time since the application started; when a flat log is
+ * being converted, it is the UTC date and time most recently read from the
+ * log (the only clock available).
+*/
+double BgBoatLogger::Now()
+{
+    if (m_host.empty())
+        return m_row.Value(m_colDate) * 24.0 * 60.0 * 60.0 + m_row.Value(m_colTime);
+    return chrono::duration<double>(chrono::steady_clock::now() - m_app.m_startTime).count();
+}
+
+#endif
+
+/// //////////////////////////////////////////////////////////////
+// Timer-driven rows
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Schedule the next timer-driven CSV row.
+ *
+ * The timer sleeps until the next aligned instant (so there is no work
+ * between rows), and the row is written on the logging strand (so it
+ * doesn't interleave with the processing of a message).
+*/
+void BgBoatLogger::ScheduleRow()
+{
+    m_rowTimer.expires_at(NextRowTime());
+    m_rowTimer.async_wait(net::bind_executor(m_logStrand, [this](beast::error_code ec)
+    {
+        if (ec)
+            return;
+        EmitRow();
+
+        // Stop once the session has ended (so that run() can return)
+        if (!m_session->Closed())
+            ScheduleRow();
+    }));
+}
+
+/**
+ * @brief Compute when the next timer-driven row is due.
+ *
+ * Rows fall on whole multiples of the interval: of the system clock, or
+ * (with -a gps) of the GPS time, extrapolated from the most recent UTC time
+ * received. Each deadline is computed afresh from the clock, so timer
+ * latency never accumulates, and a late tick skips to the next multiple
+ * rather than bunching rows together. The row's UTC is saved in m_rowUtc.
+ *
+ * @return The steady_clock time of the next row.
+*/
+chrono::steady_clock::time_point BgBoatLogger::NextRowTime()
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    double interval = m_rowInterval.count() / 1000.0;
+
+    if (m_rowAlignGps && m_gpsTime >= 0)
+    {
+        double gpsNow = m_gpsTime + chrono::duration<double>(now - m_gpsTimeAt).count();
+        double next = (floor(gpsNow / interval + 1e-9) + 1) * interval;
+        m_rowUtc = m_row.Value(m_colDate) + next / (24.0 * 60.0 * 60.0);
+        return m_gpsTimeAt + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(next - m_gpsTime));
+    }
+
+    // (Before any GPS time has been received, the timer follows the system
+    // clock, but no GPS-aligned row is written)
+    int64_t sysNow = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    int64_t next = (sysNow / m_rowInterval.count() + 1) * m_rowInterval.count();
+    m_rowUtc = m_rowAlignGps ? -1 : next / 1000.0 / (24.0 * 60.0 * 60.0) + 25569;
+    return now + chrono::milliseconds(next - sysNow);
+}
+
+/**
+ * @brief Write a timer-driven row, then start a new collection of observations.
+ *
+ * Nothing is written until the first UTC date and time have been received
+ * (which opens the output file).
+*/
+void BgBoatLogger::EmitRow()
+{
+    if (!m_timestampSeen || m_rowUtc < 0)
+        return;
+    WriteRow(m_rowUtc);
+    Clear();
+}
+
+#endif
+
+/// //////////////////////////////////////////////////////////////
+// Helper routines
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Create a JSON value from a JSON-formatted string.
+ *
+ * @param sJson A string with valid JSON
+ * @return The new JSON value.
+*/
+Json::Value BgBoatLogger::ConstructJson(string const& sJson)
+{
+    // (A reader per call, so that messages can be parsed on several threads)
+    Json::CharReaderBuilder builder;
+    unique_ptr<Json::CharReader> reader(builder.newCharReader());
+
+    Json::Value json;
+    string errors;
+    if (!reader->parse(sJson.c_str(), sJson.c_str() + sJson.size(), &json, &errors))
+    {
+        cerr << "Failed to parse the following string:" << endl << sJson << endl;
+        cerr << "Error(s): " << errors << endl;
+        return Json::nullValue;
+    }
+    return json;
+}
+
+/**
+ * @brief Schedule the next periodic statistics report.
+*/
+void BgBoatLogger::ScheduleStats()
+{
+    // (The report runs on the session's strand, which owns the statistics)
+    m_statsTimer.expires_after(chrono::seconds(m_app.m_statsInterval));
+    m_statsTimer.async_wait(net::bind_executor(m_session->get_executor(), [this](beast::error_code ec)
+    {
+        if (ec)
+            return;
+        ReportStats();
+
+        // Stop reporting once the session has ended (so that run() can return)
+        if (!m_session->Closed())
+            ScheduleStats();
+    }));
+}
+
+/**
+ * @brief Write the session statistics (outgoing queue, incoming frames) to the console.
+*/
+void BgBoatLogger::ReportStats()
+{
+    BgSessionStats const& st = m_session->Stats();
+    double ratio = st.wireBytesRead ? static_cast<double>(st.bytesRead) / st.wireBytesRead : 0;
+    double cpuPerFrame = st.framesRead ? st.readWaitCpuNs / 1000.0 / st.framesRead : 0;
+    cout << "Stats for " << m_label << ": queue " << st.queueDepth << " (max " << st.maxQueueDepth << "), sent "
+        << st.messagesSent << ", coalesced " << st.coalesced << ", dropped " << st.dropped << ", rejected " << st.rejected
+        << "; read " << st.framesRead << " frames, " << st.bytesRead << " bytes (" << st.wireBytesRead
+        << " on the wire, deflate " << (st.deflate ? "on" : "off") << ", ratio " << fixed << setprecision(2)
+        << ratio << ", up to " << setprecision(1) << cpuPerFrame << " us CPU/frame)" << defaultfloat << endl;
+
+    // Observations processed, rate limited and shed, by priority class
+    cout << "Ingest for " << m_label << ":";
+    for (int i = 0; i != PRIORITIES; i++)
+    {
+        BgPriorityCounts const& counts = m_priorityFilter.Counts(i);
+        cout << (i ? ";" : "") << " " << BgDataDefs::PriorityName(i) << " " << counts.admitted.load()
+            << " (limited " << counts.limited.load() << ", shed " << counts.shed.load() << ")";
+    }
+    cout << endl;
+}
+
+#endif
@@ -0,0 +1,83 @@
+/**
+    bg-capture-reader-class.cpp
+
+    A class which reads back the raw websocket frames in a capture file.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-capture-reader-class.h"
+#include "bg-capture-writer-class.h"
+#include <cstring>
+#include <iostream>
+
+BgCaptureReader::BgCaptureReader() :
+    m_iFile(NULL)
+{
+}
+
+BgCaptureReader::~BgCaptureReader()
+{
+    if (m_iFile)
+        fclose(m_iFile);
+}
+
+/**
+ * @brief Open a capture file, and check that it is one.
+ *
+ * @param filename The capture file.
+ * @return True if the file was opened.
+*/
+bool BgCaptureReader::Open(string const& filename)
+{
+    m_iFile = fopen(filename.c_str(), "rb");
+    if (m_iFile == NULL)
+    {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+
+    char magic[BG_CAPTURE_MAGIC_LEN];
+    if (fread(magic, 1, sizeof(magic), m_iFile) != sizeof(magic) ||
+        memcmp(magic, BG_CAPTURE_MAGIC, sizeof(magic)) != 0)
+    {
+        cerr << "Not a capture file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Read the next frame.
+ *
+ * @param frame Set to the frame text.
+ * @param monotonicNs Set to the steady clock at receipt (ns).
+ * @param realtimeNs Set to the system clock at receipt (ns since 1970).
+ * @return False at the end of the file (or of the last complete frame,
+ *      if the capture was cut short).
+*/
+bool BgCaptureReader::Next(string& frame, uint64_t& monotonicNs, int64_t& realtimeNs)
+{
+    unsigned char header[BG_CAPTURE_RECORD_HEADER];
+    if (m_iFile == NULL || fread(header, 1, sizeof(header), m_iFile) != sizeof(header))
+        return false;
+
+    uint32_t length = 0;
+    uint64_t realtime = 0;
+    monotonicNs = 0;
+    for (int i = 3; i >= 0; i--)
+        length = (length << 8) | header[i];
+    for (int i = 7; i >= 0; i--)
+    {
+        monotonicNs = (monotonicNs << 8) | header[4 + i];
+        realtime = (realtime << 8) | header[12 + i];
+    }
+    realtimeNs = static_cast<int64_t>(realtime);
+
+    frame.resize(length);
+    return length == 0 || fread(&frame[0], 1, length, m_iFile) == length;
+}
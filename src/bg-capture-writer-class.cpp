@@ -0,0 +1,98 @@
+/**
+    bg-capture-writer-class.cpp
+
+    A class which appends raw websocket frames to a capture file.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-capture-writer-class.h"
+#include <ctime>
+#include <iostream>
+
+// The capture file's stdio buffer (frames are batched into writes of this size)
+static const size_t BUFFER_BYTES = 256 * 1024;
+
+// How often the buffered frames are flushed to the file (by the receive clock, ns)
+static const uint64_t FLUSH_INTERVAL_NS = 1000000000;
+
+/**
+ * @brief Constructor.
+ *
+ * @param outDir The directory in which to write the capture file.
+*/
+BgCaptureWriter::BgCaptureWriter(string const& outDir) :
+    m_outDir(outDir), m_oFile(NULL), m_flushNs(0)
+{
+}
+
+BgCaptureWriter::~BgCaptureWriter()
+{
+    if (m_oFile)
+        fclose(m_oFile);
+}
+
+/**
+ * @brief Open a new capture file, named for the current (UTC) date and time.
+ *
+ * @return True if the file was opened.
+*/
+bool BgCaptureWriter::Open()
+{
+    time_t now = time(NULL);
+    char buffer[100];
+    strftime(buffer, 100, "%Y%m%d-%H%M%S-h5000-capture.bgc", gmtime(&now));
+    m_fileName = m_outDir + string(buffer);
+
+    m_oFile = fopen(m_fileName.c_str(), "wb");
+    if (m_oFile == NULL)
+    {
+        cerr << "Failed to open file: " << m_fileName << endl;
+        return false;
+    }
+    m_buffer.resize(BUFFER_BYTES);
+    setvbuf(m_oFile, &m_buffer[0], _IOFBF, m_buffer.size());
+    fwrite(BG_CAPTURE_MAGIC, 1, BG_CAPTURE_MAGIC_LEN, m_oFile);
+    return true;
+}
+
+/**
+ * @brief Append a frame, as received.
+ *
+ * The frame is copied from the read buffer into the file's buffer, which
+ * is written out when full, and flushed at least once a second (so that
+ * at most the last second's frames are lost in a crash) and on close.
+ *
+ * @param data The frame text.
+ * @param len The number of bytes.
+ * @param monotonicNs The steady clock at receipt (ns).
+ * @param realtimeNs The system clock at receipt (ns since 1970).
+*/
+void BgCaptureWriter::WriteFrame(const void* data, size_t len, uint64_t monotonicNs, int64_t realtimeNs)
+{
+    if (m_oFile == NULL)
+        return;
+
+    unsigned char header[BG_CAPTURE_RECORD_HEADER];
+    uint32_t length = static_cast<uint32_t>(len);
+    uint64_t realtime = static_cast<uint64_t>(realtimeNs);
+    for (int i = 0; i != 4; i++)
+        header[i] = static_cast<unsigned char>(length >> (8 * i));
+    for (int i = 0; i != 8; i++)
+    {
+        header[4 + i] = static_cast<unsigned char>(monotonicNs >> (8 * i));
+        header[12 + i] = static_cast<unsigned char>(realtime >> (8 * i));
+    }
+
+    fwrite(header, 1, sizeof(header), m_oFile);
+    fwrite(data, 1, len, m_oFile);
+    if (monotonicNs - m_flushNs >= FLUSH_INTERVAL_NS)
+    {
+        fflush(m_oFile);
+        m_flushNs = monotonicNs;
+    }
+}
@@ -0,0 +1,67 @@
+/**
+    bg-column-bitset-class.cpp
+
+    A fixed-size set of bits, one per CSV column, packed into 64-bit words.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-column-bitset-class.h"
+#include <algorithm>
+
+/**
+ * @brief Constructor.
+ *
+ * @param bits The number of bits (all initially clear).
+*/
+BgColumnBitset::BgColumnBitset(size_t bits) :
+    m_bits(0)
+{
+    Resize(bits);
+}
+
+/**
+ * @brief Change the number of bits (all bits are cleared).
+ *
+ * @param bits The new number of bits.
+*/
+void BgColumnBitset::Resize(size_t bits)
+{
+    m_bits = bits;
+    m_words.assign((bits + 63) / 64, 0);
+}
+
+/**
+ * @brief Clear all of the bits (a word at a time).
+*/
+void BgColumnBitset::ClearAll()
+{
+    fill(m_words.begin(), m_words.end(), uint64_t(0));
+}
+
+/**
+ * @brief Set all of the bits (a word at a time).
+*/
+void BgColumnBitset::SetAll()
+{
+    fill(m_words.begin(), m_words.end(), ~uint64_t(0));
+    if ((m_bits & 63) != 0)
+        m_words.back() = (uint64_t(1) << (m_bits & 63)) - 1;
+}
+
+/**
+ * @brief Count the set bits.
+ *
+ * @return The number of bits set.
+*/
+size_t BgColumnBitset::Count() const
+{
+    size_t count = 0;
+    for (vector<uint64_t>::const_iterator it = m_words.begin(); it != m_words.end(); it++)
+        count += PopCount(*it);
+    return count;
+}
@@ -3,58 +3,79 @@
 
 #include "bg-csv-writer-class.h"
 #include "bg-observation-class.h"
+#include <algorithm>
+#include <cstdio>
 #include <ctime>
 #include <fstream>
 #include <iomanip>
 
-BgCsvWriter::BgCsvWriter(string& outDir):
-    m_outDir(outDir), m_oFile(NULL)
+BgCsvWriter::BgCsvWriter(string& outDir, BgFileOptions const& options):
+    m_outDir(outDir), m_oFile(options)
 {
 std::cout<<"BgCsvWriter constructor"<<std::endl;
 }
 
-void BgCsvWriter::WriteObservations(vector<double>& observations, vector<unsigned char>& precisions, vector<bool>& seen)
+/**
+ * @brief Write one row of observations to the .csv file.
+ *
+ * Only the columns flagged in 'seen' are formatted; the row is assembled by
+ * scanning for the set bits, so the empty columns between them cost no more
+ * than their commas.
+ *
+ * @param observations The value of each column.
+ * @param precisions The digits written after the decimal point, for each column.
+ * @param seen The columns that have values to be written.
+*/
+void BgCsvWriter::WriteObservations(vector<double>& observations, vector<unsigned char>& precisions, BgColumnBitset& seen)
 {
     // Only write observations if a file is already open
-    if (m_oFile)
+    if (m_oFile.IsOpen())
     {
-        // Create a string with the values in CSV format
-        stringstream ss;
-        ss << fixed;
-        vector<double>::const_iterator it;
-        vector<unsigned char>::const_iterator jt;
-        vector<bool>::const_iterator kt;
-        for (it = observations.cbegin(), jt = precisions.cbegin(), kt = seen.cbegin();
-            it != observations.cend(); it++, jt++, kt++)
+        // Create a string with the values in CSV format (one comma between
+        // each pair of columns)
+        size_t columns = observations.size();
+        m_row.clear();
+        size_t commas = 0;
+        char buffer[64];
+        for (size_t col = seen.Next(0); col < columns; col = seen.Next(col + 1))
         {
-            if (*kt)
-                ss << setprecision(*jt) << *it;
-            ss << ",";
-
+            m_row.append(col - commas, ',');
+            commas = col;
+            int len = snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(precisions[col]), observations[col]);
+            if (len > 0)
+                m_row.append(buffer, min(static_cast<size_t>(len), sizeof(buffer) - 1));
         }
-        string s = ss.str();
-        s.pop_back();				// Remove trailing space
-        s += '\n';
+        if (columns > 0)
+            m_row.append(columns - 1 - commas, ',');
+        m_row += '\n';
 
         // Write the line to the output file
-        fputs(s.c_str(), m_oFile);
-        fflush(m_oFile);
+        m_oFile.Write(m_row);
+        m_oFile.Flush();
     }
 }
 
 
 void BgCsvWriter::NewFile(unsigned long utcdate, vector<string>& trackedItems)
 {
-    // Close existing file (if any)
-    if (m_oFile)
-        fclose(m_oFile);
-
     // Open a new .csv output file for observations from this new date
-    m_oFile = fopen(MakeFileName(utcdate).c_str(), "a");
+    Open(MakeFileName(utcdate), trackedItems);
+}
 
-    // Write a line of column headings
+/**
+ * @brief Open (append to) a named .csv file and write a line of column headings.
+ *
+ * @param filename The .csv file name (including any directory; ".gz" is
+ *      appended when compressing).
+ * @param trackedItems The column headings.
+ * @return True if the file was opened.
+*/
+bool BgCsvWriter::Open(string const& filename, vector<string>& trackedItems)
+{
+    // Open the file, with a line of column headings (repeated at the start
+    // of each part, if the file is rotated); any existing file is closed
     string headings = MakeHeaderString(trackedItems) + '\n';
-    fputs(headings.c_str(), m_oFile);
+    return m_oFile.Open(filename, headings);
 }
 
 /**
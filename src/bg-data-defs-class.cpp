@@ -0,0 +1,613 @@
+/**
+    bg-data-defs-class.cpp
+
+    A class which holds the analyzed B&G data item definitions (which items
+    are written to the .csv file, in which column, and with what precision).
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-data-defs-class.h"
+#include "bg-data-defs-table.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+// Binary cache file identification
+static const char CACHE_MAGIC[4] = { 'B', 'G', 'D', 'C' };
+static const uint32_t CACHE_VERSION = 6;
+
+// BgCsvPolicy names (as used in BgDataDefs.json and in statistics column headings)
+static const char* POLICY_NAMES[CSV_POLICIES] = { "clear", "hold", "mean", "min", "max", "count", "circmean" };
+
+// BgPriority names (as used in BgDataDefs.json)
+static const char* PRIORITY_NAMES[PRIORITIES] = { "critical", "normal", "housekeeping" };
+
+/**
+ * @brief Constructor.
+ *
+ * The object is empty until one of the Load functions is called.
+*/
+BgDataDefs::BgDataDefs()
+{
+}
+
+/**
+ * @brief Populate the definitions from the table compiled into the application.
+ *
+ * This is the normal (fast) startup path: no file is opened or parsed.
+*/
+void BgDataDefs::LoadCompiled()
+{
+    Clear();
+    for (size_t i = 0; i != BG_DATA_DEFS_COUNT; i++)
+        Add(g_bgDataDefs[i]);
+    AddExtraColumns();
+    m_source = "compiled-in table";
+}
+
+/**
+ * @brief Populate the definitions from a BgDataDefs.json file.
+ *
+ * This overrides the compiled-in table, e.g. to track additional items
+ * without rebuilding the application. The analyzed definitions are cached
+ * in a binary file (FILENAME.cache); if that cache matches the hash of the
+ * JSON file, it is mapped into memory and used instead of parsing the JSON.
+ *
+ * @param filename The path of the BgDataDefs.json file.
+ * @return True if successful; otherwise, false.
+*/
+bool BgDataDefs::LoadJson(string const& filename)
+{
+    uint64_t hash;
+    if (!HashFile(filename, hash))
+    {
+        cerr << "Couldn't open or read " << filename << endl;
+        return false;
+    }
+
+    string cacheFile = filename + ".cache";
+    if (LoadCache(cacheFile, hash))
+        return true;
+    return ParseJson(filename, cacheFile, hash);
+}
+
+/**
+ * @brief Look up the (0-based) CSV column for an Expedition column heading.
+ * @return The column index, or -1 if there is no such column.
+*/
+int BgDataDefs::CsvColumn(string const& header) const
+{
+    map<string, int>::const_iterator it = m_headerToCol.find(header);
+    return (it == m_headerToCol.end()) ? -1 : it->second;
+}
+
+/**
+ * @brief Test to see if a BgDataDefs.json item is supposed to be written to the CSV file.
+ *
+ * Not all items available on the H5000 CPU are logged to the CSV file. Only
+ * those that have a "CsvTrack" or "CsvRequired" member set to 'true' are
+ * logged and written.
+ *
+ * @param item A JSON element from the BgDataDefs.json file
+ * @return True if this data item should be written; false if not.
+*/
+bool BgDataDefs::IsTracked(Json::Value& item)
+{
+    if (item.isMember("CsvTrack") && item["CsvTrack"].asBool())
+        return true;
+    if (item.isMember("CsvRequired") && item["CsvRequired"].asBool())
+        return true;
+    return false;
+}
+
+/**
+ * @brief Test to see if a BgDataDefs.json item has options which apply
+ * whether or not it is tracked in the .csv file.
+ *
+ * @param item A JSON element from the BgDataDefs.json file
+ * @return True if the item has an "ID" and a flat log change-only filter
+ *      ("FlatDeadband", "FlatDeadbandPct" or "FlatMaxSilence") or a "Priority".
+*/
+bool BgDataDefs::HasItemOptions(Json::Value& item)
+{
+    return item.isMember("ID") && (item.isMember("FlatDeadband") || item.isMember("FlatDeadbandPct") ||
+        item.isMember("FlatMaxSilence") || item.isMember("Priority"));
+}
+
+/**
+ * @brief Convert a "CsvPolicy" (or "CsvStats" entry) name to a BgCsvPolicy.
+ *
+ * @param name "clear", "hold", "mean", "min", "max", "count" or "circmean".
+ * @param policy Set to the BgCsvPolicy (CSV_CLEAR if the name is empty).
+ * @return False if the name is not recognized; otherwise, true.
+*/
+bool BgDataDefs::ParsePolicy(string const& name, unsigned char& policy)
+{
+    policy = CSV_CLEAR;
+    if (name.empty())
+        return true;
+    for (unsigned char i = 0; i != CSV_POLICIES; i++)
+    {
+        if (name == POLICY_NAMES[i])
+        {
+            policy = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Convert a "Priority" name to a BgPriority.
+ *
+ * @param name "critical", "normal" or "housekeeping".
+ * @param priority Set to the BgPriority (PRIORITY_NORMAL if the name is empty).
+ * @return False if the name is not recognized; otherwise, true.
+*/
+bool BgDataDefs::ParsePriority(string const& name, int& priority)
+{
+    priority = PRIORITY_NORMAL;
+    if (name.empty())
+        return true;
+    for (int i = 0; i != PRIORITIES; i++)
+    {
+        if (name == PRIORITY_NAMES[i])
+        {
+            priority = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief The BgDataDefs.json name of a BgPriority.
+*/
+const char* BgDataDefs::PriorityName(int priority)
+{
+    return (priority >= 0 && priority < PRIORITIES) ? PRIORITY_NAMES[priority] : "";
+}
+
+/**
+ * @brief Read a BgDataDefs.json item's "CsvStats" (an array of statistics names).
+ *
+ * @param item A JSON element from the BgDataDefs.json file
+ * @param stats Set to the statistics (bit (1 << BgCsvPolicy) for each).
+ * @return False if a statistic is not recognized; otherwise, true.
+*/
+bool BgDataDefs::ParseStats(Json::Value& item, int& stats)
+{
+    stats = 0;
+    Json::Value names = item["CsvStats"];
+    for (Json::Value::ArrayIndex i = 0; i != names.size(); i++)
+    {
+        unsigned char stat;
+        if (!ParsePolicy(names[i].asString(), stat) || stat < CSV_MEAN)
+            return false;
+        stats |= 1 << stat;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a BgDataDefs.json file, then write the binary cache.
+ *
+ * @param filename The path of the BgDataDefs.json file.
+ * @param cacheFile The path of the binary cache to be (re)written.
+ * @param hash The hash of the JSON file (stored in the cache).
+ * @return True if successful; otherwise, false.
+*/
+bool BgDataDefs::ParseJson(string const& filename, string const& cacheFile, uint64_t hash)
+{
+    Json::Value root;
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        cerr << "Couldn't open or read " << filename << endl;
+        return false;
+    }
+    try {
+        file >> root;
+    }
+    catch (exception& e) {
+        cerr << "Couldn't parse " << filename << ": " << e.what() << endl;
+        return false;
+    }
+    file.close();
+
+    // DataItems is an array of JSON objects, one for each data item
+    Clear();
+    list<string> strings;               // (owns the strings referenced by 'defs')
+    vector<BgDataDef> defs;
+    Json::Value items = root["DataItems"];
+    for (Json::Value::ArrayIndex i = 0; i != items.size(); i++)
+    {
+        Json::Value item = items[i];
+        bool tracked = IsTracked(item);
+        if (!tracked && !HasItemOptions(item))
+            continue;
+
+        // (An item with only flat log or priority options has no CSV column)
+        if (!tracked)
+        {
+            item["CsvColumn"] = 0;
+            item["CsvHeader"] = "";
+        }
+        else if (!item.isMember("CsvHeader"))
+        {
+            cerr << "CsvHeader is missing for item ID: " << item["ID"].asUInt() << endl;
+            continue;
+        }
+        if (!item.isMember("CsvColumn"))
+        {
+            cerr << "CsvColumn is missing for item ID: " << item["ID"].asUInt() << endl;
+            continue;
+        }
+
+        unsigned char policy;
+        if (!ParsePolicy(item["CsvPolicy"].asString(), policy))
+            cerr << "Unknown CsvPolicy for item ID: " << item["ID"].asUInt() << " (using \"clear\")" << endl;
+        int stats;
+        if (!ParseStats(item, stats))
+            cerr << "Unknown CsvStats entry for item ID: " << item["ID"].asUInt() << " (ignored)" << endl;
+        int priority;
+        if (!ParsePriority(item["Priority"].asString(), priority))
+            cerr << "Unknown Priority for item ID: " << item["ID"].asUInt() << " (using \"normal\")" << endl;
+
+        // All required items are present
+        strings.push_back(item["Name"].asString());
+        const char* name = strings.back().c_str();
+        strings.push_back(item["CsvHeader"].asString());
+        const char* header = strings.back().c_str();
+        strings.push_back(item["Units"].asString());
+        const char* units = strings.back().c_str();
+        BgDataDef def = {
+            item.isMember("ID") ? item["ID"].asInt() : -1,
+            name,
+            item["CsvColumn"].asInt(),
+            header,
+            static_cast<unsigned char>(item["Decimals"].asUInt()),
+            item["Group"].asInt(),
+            units,
+            item.isMember("Instances") ? max(item["Instances"].asInt(), 1) : 1,
+            policy,
+            item["CsvMaxAge"].asDouble(),
+            stats,
+            max(item["FlatDeadband"].asDouble(), 0.0),
+            max(item["FlatDeadbandPct"].asDouble(), 0.0),
+            max(item["FlatMaxSilence"].asDouble(), 0.0),
+            priority
+        };
+        Add(def);
+        defs.push_back(def);
+    }
+    AddExtraColumns();
+    m_source = filename;
+
+    SaveCache(cacheFile, hash, defs);
+    return true;
+}
+
+/**
+ * @brief Load the definitions from the binary cache, if it is current.
+ *
+ * The cache is memory-mapped (where supported) and the records are added
+ * directly from the mapping.
+ *
+ * @param cacheFile The path of the binary cache.
+ * @param hash The hash of the JSON file the cache must have been made from.
+ * @return True if the cache was valid and loaded; otherwise, false.
+*/
+bool BgDataDefs::LoadCache(string const& cacheFile, uint64_t hash)
+{
+    const char* data = NULL;
+    size_t size = 0;
+#ifndef WIN32
+    int fd = open(cacheFile.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    data = static_cast<const char*>(map);
+#else
+    vector<char> buffer;
+    std::ifstream file(cacheFile, ios::binary);
+    if (!file.is_open())
+        return false;
+    buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#endif // WIN32
+
+    // Validate the header: magic, version, JSON hash and record count
+    bool valid = false;
+    size_t pos = sizeof(CACHE_MAGIC) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+    if (size >= pos && memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0)
+    {
+        uint32_t version, count;
+        uint64_t cachedHash;
+        memcpy(&version, data + 4, sizeof(version));
+        memcpy(&cachedHash, data + 8, sizeof(cachedHash));
+        memcpy(&count, data + 16, sizeof(count));
+        valid = (version == CACHE_VERSION && cachedHash == hash);
+
+        // Each record: id, CSV column, group, instances, stats, priority (int32); maximum
+        // age, deadband, deadband % and maximum silence (float64); decimals and
+        // policy (uint8), then the NUL-terminated name, heading and units
+        Clear();
+        for (uint32_t i = 0; valid && i != count; i++)
+        {
+            int32_t fields[6];
+            double reals[4];
+            if (pos + sizeof(fields) + sizeof(reals) + 2 > size)
+            {
+                valid = false;
+                break;
+            }
+            memcpy(fields, data + pos, sizeof(fields));
+            pos += sizeof(fields);
+            memcpy(reals, data + pos, sizeof(reals));
+            pos += sizeof(reals);
+            unsigned char decimals = static_cast<unsigned char>(data[pos++]);
+            unsigned char policy = static_cast<unsigned char>(data[pos++]);
+
+            const char* strs[3];
+            for (int k = 0; valid && k != 3; k++)
+            {
+                const char* end = static_cast<const char*>(memchr(data + pos, '\0', size - pos));
+                if (end == NULL)
+                    valid = false;
+                else {
+                    strs[k] = data + pos;
+                    pos = (end - data) + 1;
+                }
+            }
+            if (!valid)
+                break;
+
+            BgDataDef def = { fields[0], strs[0], fields[1], strs[1], decimals, fields[2], strs[2], fields[3], policy,
+                reals[0], fields[4], reals[1], reals[2], reals[3], fields[5] };
+            Add(def);
+        }
+        if (valid)
+            AddExtraColumns();
+    }
+
+#ifndef WIN32
+    munmap(const_cast<char*>(data), size);
+#endif // WIN32
+
+    if (!valid)
+    {
+        Clear();
+        return false;
+    }
+    m_source = cacheFile;
+    return true;
+}
+
+/**
+ * @brief Write the analyzed definitions to the binary cache.
+ *
+ * Failure to write the cache is not an error (the next startup will simply
+ * parse the JSON file again).
+ *
+ * @param cacheFile The path of the binary cache.
+ * @param hash The hash of the JSON file the definitions were parsed from.
+ * @param defs The definitions to be cached.
+*/
+void BgDataDefs::SaveCache(string const& cacheFile, uint64_t hash, vector<BgDataDef> const& defs)
+{
+    std::ofstream file(cacheFile, ios::binary | ios::trunc);
+    if (!file.is_open())
+        return;
+
+    uint32_t version = CACHE_VERSION;
+    uint32_t count = static_cast<uint32_t>(defs.size());
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (vector<BgDataDef>::const_iterator it = defs.begin(); it != defs.end(); it++)
+    {
+        int32_t fields[6] = { it->id, it->csvColumn, it->group, it->instances, it->stats, it->priority };
+        file.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+        double reals[4] = { it->maxAge, it->deadband, it->deadbandPct, it->maxSilence };
+        file.write(reinterpret_cast<const char*>(reals), sizeof(reals));
+        file.put(static_cast<char>(it->decimals));
+        file.put(static_cast<char>(it->policy));
+        file.write(it->name, strlen(it->name) + 1);
+        file.write(it->csvHeader, strlen(it->csvHeader) + 1);
+        file.write(it->units, strlen(it->units) + 1);
+    }
+}
+
+/**
+ * @brief Compute a 64-bit FNV-1a hash of a file's contents.
+ *
+ * @param filename The file to be hashed.
+ * @param hash Set to the hash value.
+ * @return True if the file could be read; otherwise, false.
+*/
+bool BgDataDefs::HashFile(string const& filename, uint64_t& hash)
+{
+    std::ifstream file(filename, ios::binary);
+    if (!file.is_open())
+        return false;
+
+    hash = 14695981039346656037ULL;
+    char buffer[4096];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    {
+        for (streamsize i = 0; i != file.gcount(); i++)
+        {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Discard all definitions.
+*/
+void BgDataDefs::Clear()
+{
+    m_idSlots.clear();
+    m_multiInstanceIds.clear();
+    m_deadbands.clear();
+    m_priorities.clear();
+    m_headers.clear();
+    m_precisions.clear();
+    m_policies.clear();
+    m_maxAges.clear();
+    m_angles.clear();
+    m_headerToCol.clear();
+}
+
+/**
+ * @brief Add a single data item definition.
+ *
+ * The column vectors are extended as necessary, so that there is always one
+ * (empty) column beyond the highest CSV column defined.
+ *
+ * @param def The data item definition.
+*/
+void BgDataDefs::Add(BgDataDef const& def)
+{
+    // Add the flat log filter (if any) to the dense B&G id lookup
+    if (def.id >= 0 && (def.deadband > 0 || def.deadbandPct > 0 || def.maxSilence > 0))
+    {
+        if (static_cast<size_t>(def.id) >= m_deadbands.size())
+        {
+            BgDeadband none = { 0, 0, 0 };
+            m_deadbands.resize(def.id + 1, none);
+        }
+        BgDeadband deadband = { def.deadband, def.deadbandPct, def.maxSilence };
+        m_deadbands[def.id] = deadband;
+    }
+    if (def.id >= 0 && (def.priority != PRIORITY_NORMAL || static_cast<size_t>(def.id) < m_priorities.size()))
+    {
+        if (static_cast<size_t>(def.id) >= m_priorities.size())
+            m_priorities.resize(def.id + 1, PRIORITY_NORMAL);
+        m_priorities[def.id] = static_cast<unsigned char>(def.priority);
+    }
+
+    if (def.csvColumn < 1)
+        return;
+
+    size_t col = static_cast<size_t>(def.csvColumn - 1);
+    if (col + 2 > m_headers.size())
+    {
+        m_headers.resize(col + 2);
+        m_precisions.resize(col + 2);
+        m_policies.resize(col + 2, CSV_CLEAR);
+        m_maxAges.resize(col + 2);
+        m_angles.resize(col + 2);
+    }
+    m_headers[col] = def.csvHeader;
+    m_precisions[col] = def.decimals;
+    m_policies[col] = def.policy;
+    m_maxAges[col] = def.maxAge;
+    m_angles[col] = (def.policy == CSV_CIRCMEAN || strcmp(def.units, "&deg;") == 0 ||
+        strcmp(def.units, "&deg;M") == 0 || strcmp(def.units, "&deg;T") == 0);
+    m_headerToCol[def.csvHeader] = static_cast<int>(col);
+
+    // Add this item to the B&G id lookups
+    if (def.id >= 0)
+    {
+        if (static_cast<size_t>(def.id) >= m_idSlots.size())
+        {
+            BgIdSlot empty = { -1, -1, 1, -1, 0, 0 };
+            m_idSlots.resize(def.id + 1, empty);
+        }
+        m_idSlots[def.id].col = static_cast<int>(col);
+        m_idSlots[def.id].instances = max(def.instances, 1);
+        m_idSlots[def.id].stats = def.stats;
+    }
+}
+
+/**
+ * @brief Add the CSV columns for additional instances and statistics.
+ *
+ * Called once all of the definitions have been added. For each item (in id
+ * order), the columns for instances 1..n-1 are appended after the
+ * Expedition columns, headed "HEADER_1", "HEADER_2", etc., followed by the
+ * statistics columns of each instance ("HEADER_min", "HEADER_1_min", ...),
+ * so that the Expedition column layout is unchanged. The instance columns
+ * share the item's precision and policy.
+*/
+void BgDataDefs::AddExtraColumns()
+{
+    for (size_t id = 0; id != m_idSlots.size(); id++)
+    {
+        BgIdSlot& slot = m_idSlots[id];
+        if (slot.col < 0)
+            continue;
+
+        string header = m_headers[slot.col];
+        unsigned char precision = m_precisions[slot.col];
+        slot.instCol = static_cast<int>(m_headers.size()) - 1;
+        for (int inst = 1; inst < slot.instances; inst++)
+            AddColumn(header + "_" + to_string(inst), precision, m_policies[slot.col], m_maxAges[slot.col],
+                m_angles[slot.col] != 0);
+        if (slot.instances > 1)
+            m_multiInstanceIds.push_back(static_cast<int>(id));
+
+        slot.statCol = static_cast<int>(m_headers.size()) - 1;
+        slot.statCount = 0;
+        for (int stat = CSV_MEAN; stat != CSV_POLICIES; stat++)
+            slot.statCount += (slot.stats >> stat) & 1;
+        for (int inst = 0; slot.statCount != 0 && inst != slot.instances; inst++)
+        {
+            string prefix = (inst == 0) ? header : header + "_" + to_string(inst);
+            for (int stat = CSV_MEAN; stat != CSV_POLICIES; stat++)
+            {
+                if (slot.stats & (1 << stat))
+                    AddColumn(prefix + "_" + POLICY_NAMES[stat], (stat == CSV_COUNT) ? 0 : precision,
+                        static_cast<unsigned char>(stat), 0, m_angles[slot.col] && stat != CSV_COUNT);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Append a column (keeping one empty column beyond the highest column, as Add does).
+*/
+void BgDataDefs::AddColumn(string const& header, unsigned char precision, unsigned char policy, double maxAge, bool angle)
+{
+    size_t col = m_headers.size() - 1;
+    m_headers[col] = header;
+    m_precisions[col] = precision;
+    m_policies[col] = policy;
+    m_maxAges[col] = maxAge;
+    m_angles[col] = angle;
+    m_headerToCol[header] = static_cast<int>(col);
+    m_headers.push_back(string());
+    m_precisions.push_back(0);
+    m_policies.push_back(CSV_CLEAR);
+    m_maxAges.push_back(0);
+    m_angles.push_back(0);
+}
@@ -3,12 +3,77 @@
 
 #include "bg-flat-writer-class.h"
 #include "bg-observation-class.h"
+#include <chrono>
+#include <cmath>
 #include <ctime>
 
+// Instances of a filtered item which have their own last value (any others are always written)
+static const int FLAT_INSTANCES = 4;
 
-BgFlatWriter::BgFlatWriter(string& outDir):
-    m_outDir(outDir), m_oFile(NULL)
+
+BgFlatWriter::BgFlatWriter(string& outDir, BgFileOptions const& options):
+    m_outDir(outDir), m_oFile(options)
+{
+}
+
+/**
+ * @brief Set the change-only filters (from BgDataDefs::Deadbands).
+ *
+ * @param deadbands The filter for each B&G id (all zero, or beyond the end, for none).
+*/
+void BgFlatWriter::SetDeadbands(vector<BgDeadband> const& deadbands)
 {
+    m_deadbands = deadbands;
+    LastValue none = { 0, 0, false, false };
+    m_last.assign(m_deadbands.size() * FLAT_INSTANCES, none);
+}
+
+/**
+ * @brief Apply an item's change-only filter to an observation.
+ *
+ * @param o A BgObservation object with the new data.
+ * @return True if the observation should be written (and, if so, records
+ *      it as the last value written).
+*/
+bool BgFlatWriter::Changed(BgObservation& o)
+{
+    int id = o.getId();
+    int inst = o.getInst();
+    if (id < 0 || static_cast<size_t>(id) >= m_deadbands.size() || inst < 0 || inst >= FLAT_INSTANCES ||
+        id == 34 || id == 35)
+        return true;
+    BgDeadband const& deadband = m_deadbands[id];
+    if (deadband.abs <= 0 && deadband.pct <= 0 && deadband.maxSilence <= 0)
+        return true;
+
+    // (An observation read back from an unstamped flat log uses the time now)
+    int64_t ns = static_cast<int64_t>(o.getMonotonicNs());
+    if (ns == 0)
+        ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+    LastValue& last = m_last[id * FLAT_INSTANCES + inst];
+    double val = o.getVal();
+    bool write = !last.written || o.isValid() != last.valid;
+    if (!write)
+    {
+        double change = fabs(val - last.val);
+        if (deadband.abs > 0 || deadband.pct > 0)
+            write = (deadband.abs > 0 && change > deadband.abs) ||
+                (deadband.pct > 0 && change > deadband.pct / 100 * fabs(last.val));
+        else
+            write = (val != last.val);
+    }
+    if (!write && deadband.maxSilence > 0)
+        write = (ns - last.ns) >= static_cast<int64_t>(deadband.maxSilence * 1e9);
+
+    if (write)
+    {
+        last.val = val;
+        last.ns = ns;
+        last.valid = o.isValid();
+        last.written = true;
+    }
+    return write;
 }
 
 /**
@@ -19,19 +84,21 @@ BgFlatWriter::BgFlatWriter(string& outDir):
 void BgFlatWriter::ProcessObservation(BgObservation& o) 
 {
     // If the flat log has not been opened, open it.
-    if (m_oFile == NULL)
+    if (!m_oFile.IsOpen())
     {
         string filename = m_outDir + "flatlog.log";
-        m_oFile = fopen(filename.c_str(), "a");
+        m_oFile.Open(filename);
     }
 
     // Write the string representation of the observation to the file
-    fputs(o.str().c_str(), m_oFile);
+    // (unless it is filtered out as unchanged)
+    if (Changed(o))
+        m_oFile.Write(o.str());
 
     // Since we may not exit the application gracefully, flush the write buffer 
-    // every change in timestamp
+    // every change in timestamp (when compressing, frames end on a timestamp)
     if (o.getId() == 35)
-        fflush(m_oFile);
+        m_oFile.Flush();
 }
 
 
@@ -42,13 +109,10 @@ void BgFlatWriter::ProcessObservation(BgObservation& o)
 */
 void BgFlatWriter::NewFile(unsigned long int utcdate)
 {
-    if (m_oFile != NULL) {
-        fclose(m_oFile);
-    }
-
     // Open a new .log output file for observations from this new date
+    // (closing the existing file, if any)
     string filename = m_outDir + MakeFileName(utcdate);
-    m_oFile = fopen(filename.c_str(), "a");
+    m_oFile.Open(filename);
 }
 
 
@@ -0,0 +1,428 @@
+/**
+    bg-frame-file-class.cpp
+
+    An output file which is either written directly or compressed in
+    independent gzip frames on a background thread.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-frame-file-class.h"
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/crc.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // __linux__
+
+namespace zlib = boost::beast::zlib;
+
+/// //////////////////////////////////////////////////////////////
+// Public Member Functions
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Constructor.
+ *
+ * @param options How the file is compressed and rotated.
+ * @param level The deflate compression level (1..9).
+*/
+BgFrameFile::BgFrameFile(BgFileOptions const& options, int level) :
+    m_options(options), m_level(level), m_file(NULL), m_part(0), m_partBytes(0),
+    m_preallocated(false), m_stopping(false)
+{
+}
+
+/**
+ * @brief Destructor: close the file, and wait for any queued work to be done.
+*/
+BgFrameFile::~BgFrameFile()
+{
+    Close();
+    if (m_thread.joinable())
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_ready.notify_one();
+        m_thread.join();
+    }
+}
+
+/**
+ * @brief Open (append to) a file, closing the current one (if any).
+ *
+ * If the file has already been rotated (e.g. by an earlier run of the
+ * logger), its latest part is appended to.
+ *
+ * @param filename The file name (".gz" is appended when compressing).
+ * @param header A header (e.g. a line of column headings) to be written at
+ *      the start of each part.
+ * @return True if the file was opened.
+*/
+bool BgFrameFile::Open(string const& filename, string const& header)
+{
+    Close();
+    m_baseName = filename;
+    m_header = header;
+
+    m_part = 0;
+    while (Exists(PartName(m_part)) || Exists(PartName(m_part) + ".gz"))
+        m_part++;
+    if (m_part > 0 && Exists(PartName(m_part - 1) + (Compressed() ? ".gz" : "")))
+        m_part--;
+    return OpenPart();
+}
+
+/**
+ * @brief Write (or, when compressing, collect) data.
+ *
+ * @param data The bytes to be written.
+ * @param len The number of bytes.
+*/
+void BgFrameFile::Write(const char* data, size_t len)
+{
+    if (m_file == NULL)
+        return;
+    if (Compressed())
+        m_frame.append(data, len);
+    else
+        fwrite(data, 1, len, m_file);
+    m_partBytes += len;
+}
+
+/**
+ * @brief Mark the end of a record.
+ *
+ * An uncompressed file is flushed; when compressing, the frame is queued
+ * for compression once it is large enough (so frames always end on a
+ * record boundary). The file is rotated here, if it is due.
+*/
+void BgFrameFile::Flush()
+{
+    if (m_file == NULL)
+        return;
+    if (!Compressed())
+        fflush(m_file);
+    else if (m_frame.size() >= m_options.frameBytes)
+        QueueFrame(false);
+
+    if (RotationDue())
+    {
+        Close();
+        m_part++;
+        OpenPart();
+    }
+}
+
+/**
+ * @brief Close the file (on the background thread, if there is one; a
+ * compressed file's last frame is written first).
+*/
+void BgFrameFile::Close()
+{
+    if (m_file == NULL)
+        return;
+    if (Compressed())
+        QueueFrame(true);
+    else if (m_thread.joinable())
+    {
+        Job job;
+        job.file = m_file;
+        job.preallocate = 0;
+        job.close = true;
+        if (m_options.compressClosed)
+            job.compressName = PartName(m_part);
+        QueueJob(job);
+    }
+    else
+        fclose(m_file);
+    m_file = NULL;
+}
+
+#endif
+
+
+/// //////////////////////////////////////////////////////////////
+// Rotation
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Open the current part, and write its header.
+ *
+ * @return True if the file was opened.
+*/
+bool BgFrameFile::OpenPart()
+{
+    string filename = PartName(m_part);
+    m_file = fopen(Compressed() ? (filename + ".gz").c_str() : filename.c_str(), Compressed() ? "ab" : "a");
+    if (m_file == NULL)
+        return false;
+
+    // (The background thread is needed for compression, and to take the
+    // closing of rotated parts off the writing thread)
+    if (!m_thread.joinable() && (Compressed() || m_options.compressClosed ||
+        m_options.rotateBytes > 0 || m_options.rotateSeconds > 0))
+    {
+        m_thread = thread(&BgFrameFile::DoJobs, this);
+    }
+
+    // Reserve the space for an uncompressed part of known size
+    m_preallocated = !Compressed() && m_options.rotateBytes > 0;
+    if (m_preallocated)
+    {
+        Job job;
+        job.file = m_file;
+        job.preallocate = m_options.rotateBytes + m_options.rotateBytes / 16;
+        job.close = false;
+        QueueJob(job);
+    }
+
+    // (An uncompressed part being appended to is already partly full)
+    m_partBytes = 0;
+    if (!Compressed() && fseek(m_file, 0, SEEK_END) == 0)
+        m_partBytes = static_cast<size_t>(max(ftell(m_file), 0L));
+    m_partStart = chrono::steady_clock::now();
+    if (!m_header.empty())
+        Write(m_header);
+    return true;
+}
+
+/**
+ * @brief Test whether the current part is big (or old) enough to be rotated.
+*/
+bool BgFrameFile::RotationDue() const
+{
+    if (m_options.rotateBytes > 0 && m_partBytes >= m_options.rotateBytes)
+        return true;
+    return m_options.rotateSeconds > 0 &&
+        chrono::steady_clock::now() - m_partStart >= chrono::seconds(m_options.rotateSeconds);
+}
+
+/**
+ * @brief The name of a part: the first part has the base name; later parts
+ * have a sequence number before the extension (e.g. 20200530-flatlog-001.log).
+ *
+ * @param part The part number.
+*/
+string BgFrameFile::PartName(int part) const
+{
+    if (part == 0)
+        return m_baseName;
+
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), "-%03d", part);
+    size_t slash = m_baseName.find_last_of("/\\");
+    size_t dot = m_baseName.find_last_of('.');
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+        return m_baseName + suffix;
+    return m_baseName.substr(0, dot) + suffix + m_baseName.substr(dot);
+}
+
+/**
+ * @brief Test whether a file exists.
+*/
+bool BgFrameFile::Exists(string const& filename)
+{
+    FILE* f = fopen(filename.c_str(), "r");
+    if (f == NULL)
+        return false;
+    fclose(f);
+    return true;
+}
+
+#endif
+
+
+/// //////////////////////////////////////////////////////////////
+// Background thread
+/// //////////////////////////////////////////////////////////////
+
+#if (true)
+
+/**
+ * @brief Queue work for the background thread.
+ *
+ * @param job The work (moved to the queue).
+*/
+void BgFrameFile::QueueJob(Job& job)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_ready.notify_one();
+}
+
+/**
+ * @brief Hand the collected frame to the background thread.
+ *
+ * @param close Close the file once the frame has been written?
+*/
+void BgFrameFile::QueueFrame(bool close)
+{
+    Job job;
+    job.file = m_file;
+    job.preallocate = 0;
+    job.data.swap(m_frame);
+    job.close = close;
+    QueueJob(job);
+    m_frame.reserve(m_options.frameBytes + m_options.frameBytes / 8);
+}
+
+/**
+ * @brief The background thread: do the queued work until stopped.
+ *
+ * The queue is emptied before the thread exits.
+*/
+void BgFrameFile::DoJobs()
+{
+    string out;                     // (reused for each frame, to avoid reallocation)
+    while (true)
+    {
+        Job job;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_ready.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty())
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        if (job.preallocate > 0)
+            Preallocate(job.file, job.preallocate);
+        if (!job.data.empty())
+            WriteMember(job.file, job.data, out);
+        if (job.close)
+        {
+            TrimPreallocation(job.file);
+            fclose(job.file);
+        }
+        if (!job.compressName.empty())
+            CompressFile(job.compressName, out);
+    }
+}
+
+/**
+ * @brief Compress a frame as a complete gzip member (RFC 1952), append it
+ * to the file and flush the file.
+ *
+ * @param file The file.
+ * @param data The uncompressed frame.
+ * @param out A buffer for the compressed member.
+*/
+void BgFrameFile::WriteMember(FILE* file, string const& data, string& out)
+{
+    // (the deflate stream is raw: the gzip header and trailer are added here)
+    static const unsigned char header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+
+    zlib::deflate_stream ds;
+    ds.reset(m_level, 15, 8, zlib::Strategy::normal);
+    out.resize(sizeof(header) + ds.upper_bound(data.size()) + 8);
+    memcpy(&out[0], header, sizeof(header));
+
+    zlib::z_params zs;
+    zs.next_in = data.data();
+    zs.avail_in = data.size();
+    zs.next_out = &out[sizeof(header)];
+    zs.avail_out = out.size() - sizeof(header) - 8;
+    boost::beast::error_code ec;
+    ds.write(zs, zlib::Flush::finish, ec);
+    if (ec != zlib::error::end_of_stream)
+    {
+        cerr << "Compression failed: " << ec.message() << endl;
+        return;
+    }
+
+    // Trailer: CRC-32 and length of the uncompressed data (both little-endian)
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    uint32_t trailer[2] = { crc.checksum(), static_cast<uint32_t>(data.size()) };
+    size_t len = sizeof(header) + zs.total_out;
+    for (int i = 0; i != 8; i++)
+        out[len + i] = static_cast<char>((trailer[i / 4] >> (8 * (i % 4))) & 0xff);
+    len += 8;
+
+    fwrite(out.data(), 1, len, file);
+    fflush(file);
+}
+
+/**
+ * @brief Compress a closed file (as .gz, in frames, like the files compressed
+ * as they are written), then remove it.
+ *
+ * @param filename The file.
+ * @param out A buffer for the compressed members.
+*/
+void BgFrameFile::CompressFile(string const& filename, string& out)
+{
+    FILE* in = fopen(filename.c_str(), "rb");
+    if (in == NULL)
+        return;
+    FILE* gz = fopen((filename + ".gz").c_str(), "ab");
+    if (gz == NULL)
+    {
+        cerr << "Failed to open file: " << filename << ".gz" << endl;
+        fclose(in);
+        return;
+    }
+
+    string frame(1024 * 1024, '\0');
+    size_t len;
+    while ((len = fread(&frame[0], 1, frame.size(), in)) > 0)
+        WriteMember(gz, frame.substr(0, len), out);
+    fclose(in);
+    fclose(gz);
+    remove(filename.c_str());
+}
+
+/**
+ * @brief Reserve disk space for a file (without changing its size), so
+ * that appending to it doesn't allocate blocks (Linux only).
+ *
+ * @param file The file.
+ * @param bytes The number of bytes to reserve.
+*/
+void BgFrameFile::Preallocate(FILE* file, size_t bytes)
+{
+#ifdef __linux__
+    fallocate(fileno(file), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(bytes));
+#else
+    (void)file;
+    (void)bytes;
+#endif // __linux__
+}
+
+/**
+ * @brief Release any reserved space beyond the end of a file, before it is closed.
+ *
+ * @param file The file.
+*/
+void BgFrameFile::TrimPreallocation(FILE* file)
+{
+#ifdef __linux__
+    fflush(file);
+    struct stat st;
+    if (fstat(fileno(file), &st) == 0)
+        ftruncate(fileno(file), st.st_size);
+#else
+    (void)file;
+#endif // __linux__
+}
+
+#endif
@@ -0,0 +1,417 @@
+/**
+    bg-maneuver-detector-class.cpp
+
+    A class which detects tacks and gybes in the stream of observations, and
+    writes each one to an events file.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-maneuver-detector-class.h"
+#include "bg-observation-class.h"
+#include "bg-row-accumulator-class.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <limits>
+
+// Turn detection (deg/s, s)
+static const double TURN_START_RATE = 3.0;  // a turn starts above this rate of turn
+static const double TURN_END_RATE = 1.0;    // ... and ends once the rate has stayed below this
+static const double TURN_SETTLE = 2.0;      // ... for this long
+static const double TURN_MAX = 60.0;        // a longer turn (e.g. circling) is not a maneuver
+static const double RATE_MIN_INTERVAL = 0.5;    // the shortest interval over which a rate is derived from the heading
+
+// The TWA is settled on a side (for detecting a change of side) between these angles (deg)
+static const double SIDE_MIN_TWA = 15.0;
+static const double SIDE_MAX_TWA = 165.0;
+
+// The windows, relative to the start (pre) and end (post) of the turn (s)
+static const int PRE_FROM = 35;
+static const int PRE_TO = 5;
+static const double POST_DELAY = 10.0;
+static const double POST_SECONDS = 30.0;
+static const int RING_SECONDS = PRE_FROM + 5;
+
+// The columns of the events file, before the pre and post windows
+enum {
+    EVENT_UTC = 0,
+    EVENT_BOAT,
+    EVENT_TYPE,
+    EVENT_END_UTC,
+    EVENT_DURATION,
+    EVENT_TURN,
+    EVENT_MIN_BSP,
+    EVENT_TWD_SHIFT,
+    EVENT_POST_SECONDS,
+    EVENT_FIRST_WINDOW
+};
+
+static const char* CHANNEL_NAMES[MANEUVER_CHANNELS] = { "HDG", "TWD", "TWA", "AWA", "TWS", "AWS", "BSP", "Heel" };
+static const unsigned char CHANNEL_PRECISIONS[MANEUVER_CHANNELS] = { 1, 1, 1, 1, 2, 2, 2, 1 };
+
+/**
+ * @brief Constructor.
+ *
+ * @param outDir The directory in which to write the events file.
+ * @param boat The boat index (written to the "Boat" column).
+ * @param options Compression and rotation of the events file.
+*/
+BgManeuverDetector::BgManeuverDetector(string& outDir, int boat, BgFileOptions const& options) :
+    m_outDir(outDir), m_boat(boat), m_writer(outDir, options),
+    m_twa(numeric_limits<double>::quiet_NaN()), m_hdg(numeric_limits<double>::quiet_NaN()),
+    m_prevHdg(numeric_limits<double>::quiet_NaN()), m_rateHdg(numeric_limits<double>::quiet_NaN()),
+    m_rateAt(0), m_rate(0), m_haveRot(false), m_side(0),
+    m_state(STEADY), m_turnStart(0), m_turnStartUtc(0), m_lastFast(0), m_startSide(0), m_startForward(false),
+    m_turn(0), m_minBsp(-1), m_ring(RING_SECONDS), m_postStart(0), m_now(0), m_pending(false), m_maneuvers(0)
+{
+    m_headers = { "Utc", "Boat", "Maneuver", "EndUtc", "Duration", "Turn", "MinBSP", "TWDShift", "PostSeconds" };
+    m_precisions = { 6, 0, 0, 6, 1, 1, 2, 1, 0 };
+    static const char* WINDOWS[] = { "Pre_", "Post_" };
+    for (int w = 0; w != 2; w++)
+    {
+        for (int c = 0; c != MANEUVER_CHANNELS; c++)
+        {
+            m_headers.push_back(string(WINDOWS[w]) + CHANNEL_NAMES[c]);
+            m_precisions.push_back(CHANNEL_PRECISIONS[c]);
+        }
+    }
+    m_row.assign(m_headers.size(), 0.0);
+    m_rowSeen.Resize(m_headers.size());
+    m_headers.push_back(string());
+
+    for (vector<Sums>::iterator it = m_ring.begin(); it != m_ring.end(); it++)
+        Clear(*it);
+    Clear(m_post);
+}
+
+/**
+ * @brief Destructor: write the maneuver whose post window is being collected.
+*/
+BgManeuverDetector::~BgManeuverDetector()
+{
+    Flush();
+}
+
+/**
+ * @brief Start the events file for a date.
+ *
+ * @param utcdate An integer representation of the number of days since Jan 0, 1900.
+*/
+void BgManeuverDetector::NewFile(unsigned long int utcdate)
+{
+    // Convert the Excel-format date to a tm struct (in UTC time)
+    double dateExcel = utcdate;
+    time_t tsUnix = (time_t)(dateExcel - 25569) * 86400;
+    struct tm* dateTm = gmtime(&tsUnix);
+    char buffer[100];
+    strftime(buffer, 100, "%Y%m%d-h5000-maneuvers.csv", dateTm);
+    m_writer.Open(m_outDir + buffer, m_headers);
+}
+
+/**
+ * @brief Process an observation (instance 0 of a data item).
+ *
+ * @param id The data item id.
+ * @param val The value.
+ * @param now The processing clock (seconds; see BgBoatLogger::Now).
+ * @param utcDateTime The Excel-compatible UTC date and time.
+ * @return True if a maneuver was completed (and written; see LastManeuver).
+*/
+bool BgManeuverDetector::Observe(int id, double val, double now, double utcDateTime)
+{
+    // Identify the channel (and keep the values that drive the detection)
+    int channel;
+    switch (id)
+    {
+    case BG_ID_HDG:
+        channel = MANEUVER_HDG;
+        if (m_state == TURNING && !std::isnan(m_hdg))
+            m_turn += remainder(val - m_hdg, 360.0);
+        m_prevHdg = m_hdg;
+        m_hdg = val;
+        if (!m_haveRot)
+        {
+            // (Derive the rate of turn from the heading, over at least half a second)
+            if (std::isnan(m_rateHdg) || now < m_rateAt)
+            {
+                m_rateHdg = val;
+                m_rateAt = now;
+            }
+            else if (now - m_rateAt >= RATE_MIN_INTERVAL)
+            {
+                m_rate = remainder(val - m_rateHdg, 360.0) / (now - m_rateAt);
+                m_rateHdg = val;
+                m_rateAt = now;
+            }
+        }
+        break;
+    case BG_ID_ROT:
+        channel = -1;
+        m_rate = val;
+        m_haveRot = true;
+        break;
+    case BG_ID_TWA:
+        channel = MANEUVER_TWA;
+        m_twa = remainder(val, 360.0);
+        if (m_state == STEADY && fabs(m_twa) >= SIDE_MIN_TWA && fabs(m_twa) <= SIDE_MAX_TWA)
+            m_side = (m_twa < 0) ? -1 : 1;
+        break;
+    case BG_ID_TWD:
+        channel = MANEUVER_TWD;
+        break;
+    case BG_ID_AWA:
+        channel = MANEUVER_AWA;
+        break;
+    case BG_ID_TWS:
+        channel = MANEUVER_TWS;
+        break;
+    case BG_ID_AWS:
+        channel = MANEUVER_AWS;
+        break;
+    case BG_ID_BSP:
+        channel = MANEUVER_BSP;
+        if (m_state == TURNING && (m_minBsp < 0 || val < m_minBsp))
+            m_minBsp = val;
+        break;
+    case BG_ID_HEEL:
+        channel = MANEUVER_HEEL;
+        break;
+    default:
+        return false;
+    }
+
+    m_now = now;
+
+    // Add the value to its one second bin of the ring (the pre window), and
+    // to the post window (if it is being collected)
+    if (channel >= 0)
+    {
+        int64_t second = static_cast<int64_t>(floor(now));
+        Sums& bin = m_ring[static_cast<size_t>(((second % RING_SECONDS) + RING_SECONDS) % RING_SECONDS)];
+        if (bin.second != second)
+        {
+            Clear(bin);
+            bin.second = second;
+        }
+        Add(bin, channel, val);
+        if (m_pending && now >= m_postStart && now < m_postStart + POST_SECONDS)
+            Add(m_post, channel, val);
+    }
+
+    // Complete the maneuver once its post window has passed
+    bool completed = false;
+    if (m_pending && now >= m_postStart + POST_SECONDS)
+    {
+        m_maneuver.postSeconds = POST_SECONDS;
+        completed = Emit();
+    }
+
+    // Follow the turn
+    switch (m_state)
+    {
+    case STEADY:
+        if ((id == BG_ID_ROT || id == BG_ID_HDG) && fabs(m_rate) > TURN_START_RATE)
+        {
+            // (A turn that starts before the last maneuver's post window has
+            // passed cuts the window short)
+            if (m_pending)
+            {
+                m_maneuver.postSeconds = max(now - m_postStart, 0.0);
+                completed = Emit();
+            }
+            StartTurn(now, utcDateTime);
+        }
+        break;
+    case TURNING:
+        if (fabs(m_rate) > TURN_END_RATE)
+            m_lastFast = now;
+        if (now - m_turnStart > TURN_MAX || now < m_turnStart)
+            m_state = STEADY;
+        else if (now - m_lastFast >= TURN_SETTLE)
+            EndTurn(now, utcDateTime);
+        break;
+    }
+    return completed;
+}
+
+/**
+ * @brief Write the maneuver whose post window is being collected (e.g. at
+ * the end of the session), with as much of the window as was observed.
+ *
+ * @return True if a maneuver was completed (see LastManeuver).
+*/
+bool BgManeuverDetector::Flush()
+{
+    if (!m_pending)
+        return false;
+    m_maneuver.postSeconds = min(max(m_now - m_postStart, 0.0), POST_SECONDS);
+    return Emit();
+}
+
+/**
+ * @brief Start following a turn (taking the pre window from the ring).
+*/
+void BgManeuverDetector::StartTurn(double now, double utcDateTime)
+{
+    m_state = TURNING;
+    m_turnStart = m_lastFast = now;
+    m_turnStartUtc = utcDateTime;
+    m_startSide = m_side;
+    m_startForward = !std::isnan(m_twa) && fabs(m_twa) < 90.0;
+    m_minBsp = -1;
+
+    // (The heading change that signalled the turn is part of it)
+    m_turn = (std::isnan(m_hdg) || std::isnan(m_prevHdg)) ? 0 : remainder(m_hdg - m_prevHdg, 360.0);
+
+    // (The bins of the seconds from PRE_FROM to PRE_TO before the turn)
+    Sums pre;
+    Clear(pre);
+    int64_t second = static_cast<int64_t>(floor(now));
+    for (vector<Sums>::const_iterator it = m_ring.begin(); it != m_ring.end(); it++)
+    {
+        if (it->second >= second - PRE_FROM && it->second < second - PRE_TO)
+            Add(pre, *it);
+    }
+    Mean(pre, m_maneuver.pre);
+}
+
+/**
+ * @brief The turn has ended: if the wind changed sides, the turn was a tack
+ * (or gybe), and its post window is collected.
+*/
+void BgManeuverDetector::EndTurn(double now, double utcDateTime)
+{
+    m_state = STEADY;
+    int endSide = 0;
+    if (!std::isnan(m_twa) && fabs(m_twa) >= SIDE_MIN_TWA && fabs(m_twa) <= SIDE_MAX_TWA)
+        endSide = (m_twa < 0) ? -1 : 1;
+    if (m_startSide == 0 || endSide == 0 || endSide == m_startSide)
+        return;
+
+    m_side = endSide;
+    m_maneuver.type = m_startForward ? MANEUVER_TACK : MANEUVER_GYBE;
+    m_maneuver.startUtc = m_turnStartUtc;
+    m_maneuver.endUtc = utcDateTime;
+    m_maneuver.duration = m_lastFast - m_turnStart;
+    m_maneuver.turn = m_turn;
+    m_maneuver.minBsp = m_minBsp;
+    m_maneuver.postSeconds = 0;
+    m_postStart = m_lastFast + POST_DELAY;
+    Clear(m_post);
+    m_pending = true;
+}
+
+/**
+ * @brief Complete the maneuver (taking the means of its post window), and
+ * write it to the events file.
+ *
+ * @return True (the maneuver is available from LastManeuver).
+*/
+bool BgManeuverDetector::Emit()
+{
+    Mean(m_post, m_maneuver.post);
+    m_pending = false;
+    m_maneuvers++;
+    Write();
+    return true;
+}
+
+/**
+ * @brief Write the last maneuver to the events file.
+*/
+void BgManeuverDetector::Write()
+{
+    BgManeuver const& m = m_maneuver;
+    m_rowSeen.ClearAll();
+    m_row[EVENT_UTC] = m.startUtc;
+    m_row[EVENT_BOAT] = m_boat;
+    m_row[EVENT_TYPE] = m.type;
+    m_row[EVENT_END_UTC] = m.endUtc;
+    m_row[EVENT_DURATION] = m.duration;
+    m_row[EVENT_TURN] = m.turn;
+    m_row[EVENT_POST_SECONDS] = m.postSeconds;
+    for (int i = EVENT_UTC; i != EVENT_FIRST_WINDOW; i++)
+        m_rowSeen.Set(i);
+    m_row[EVENT_MIN_BSP] = m.minBsp;
+    m_rowSeen.Assign(EVENT_MIN_BSP, m.minBsp >= 0);
+    m_row[EVENT_TWD_SHIFT] = remainder(m.post.mean[MANEUVER_TWD] - m.pre.mean[MANEUVER_TWD], 360.0);
+    m_rowSeen.Assign(EVENT_TWD_SHIFT, m.pre.valid[MANEUVER_TWD] && m.post.valid[MANEUVER_TWD]);
+
+    BgManeuverWindow const* windows[] = { &m.pre, &m.post };
+    for (int w = 0; w != 2; w++)
+    {
+        for (int c = 0; c != MANEUVER_CHANNELS; c++)
+        {
+            size_t col = EVENT_FIRST_WINDOW + w * MANEUVER_CHANNELS + c;
+            m_row[col] = windows[w]->mean[c];
+            m_rowSeen.Assign(col, windows[w]->valid[c]);
+        }
+    }
+    m_writer.WriteObservations(m_row, m_precisions, m_rowSeen);
+}
+
+/**
+ * @brief Add a value to a channel's sums.
+*/
+void BgManeuverDetector::Add(Sums& sums, int channel, double val)
+{
+    if (IsAngle(channel))
+    {
+        double rad = val * (BG_PI / 180.0);
+        sums.sums[channel] += sin(rad);
+        sums.cosSums[channel] += cos(rad);
+    }
+    else
+        sums.sums[channel] += val;
+    sums.counts[channel]++;
+}
+
+/**
+ * @brief Add one set of sums to another.
+*/
+void BgManeuverDetector::Add(Sums& total, Sums const& sums)
+{
+    for (int c = 0; c != MANEUVER_CHANNELS; c++)
+    {
+        total.sums[c] += sums.sums[c];
+        total.cosSums[c] += sums.cosSums[c];
+        total.counts[c] += sums.counts[c];
+    }
+}
+
+void BgManeuverDetector::Clear(Sums& sums)
+{
+    fill(sums.sums, sums.sums + MANEUVER_CHANNELS, 0.0);
+    fill(sums.cosSums, sums.cosSums + MANEUVER_CHANNELS, 0.0);
+    fill(sums.counts, sums.counts + MANEUVER_CHANNELS, 0u);
+    sums.second = -1;
+}
+
+/**
+ * @brief The mean of each channel (headings and TWD from 0 to 360; wind
+ * angles from -180 to 180).
+*/
+void BgManeuverDetector::Mean(Sums const& sums, BgManeuverWindow& window)
+{
+    for (int c = 0; c != MANEUVER_CHANNELS; c++)
+    {
+        window.valid[c] = (sums.counts[c] != 0);
+        window.mean[c] = 0;
+        if (!window.valid[c])
+            continue;
+        if (IsAngle(c))
+        {
+            double deg = atan2(sums.sums[c], sums.cosSums[c]) * (180.0 / BG_PI);
+            if ((c == MANEUVER_HDG || c == MANEUVER_TWD) && deg < 0)
+                deg += 360.0;
+            window.mean[c] = deg;
+        }
+        else
+            window.mean[c] = sums.sums[c] / sums.counts[c];
+    }
+}
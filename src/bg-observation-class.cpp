@@ -27,7 +27,8 @@
  * @param data A Json::Value object with the observation data (in B&G websocket format).
 */
 BgObservation::BgObservation(Json::Value data) :
-    m_id(0), m_val(0), m_sysVal(0), m_inst(0), m_valid(false), m_damped(false), m_dampedVal(0)
+    m_id(0), m_val(0), m_sysVal(0), m_inst(0), m_valid(false), m_damped(false), m_dampedVal(0),
+    m_monotonicNs(0), m_realtimeNs(0)
 {
     // 'id' and 'valid' are always present
     m_id = data["id"].asInt();
@@ -54,12 +55,15 @@ BgObservation::BgObservation(Json::Value data) :
  * When the application is used off the boat (away from a live websocket
  * session), the observation can be constructed from a line in the flatlog
  * file.  This function takes the string associated with a single observation/
- * single line in the file and creates an Observation object from it.
+ * single line in the file and creates an Observation object from it. The
+ * fields are read in the order str() writes them (the receive times are
+ * optional, as older flat logs don't have them).
  *
  * @param data A string with the observation data (in flatlog format).
 */
 BgObservation::BgObservation(string data) :
-    m_id(0), m_val(0), m_sysVal(0), m_inst(0), m_valid(false), m_damped(false), m_dampedVal(0)
+    m_id(0), m_val(0), m_sysVal(0), m_inst(0), m_valid(false), m_damped(false), m_dampedVal(0),
+    m_monotonicNs(0), m_realtimeNs(0)
 {
 
 	// This try block is intended to capture garbled flatfile lines (such as
@@ -71,15 +75,23 @@ BgObservation::BgObservation(string data) :
 		start += idx + 1;
 		m_valid = (stoul(data.substr(start), &idx) == 1);
 		start += idx + 1;
+		m_inst = stoul(data.substr(start), &idx);
+		start += idx + 1;
+		m_damped = (stoul(data.substr(start), &idx) == 1);
+		start += idx + 1;
 		m_val = stod(data.substr(start), &idx);
 		start += idx + 1;
 		m_sysVal = stod(data.substr(start), &idx);
 		start += idx + 1;
 		m_dampedVal = stod(data.substr(start), &idx);
-		start += idx + 1;
-		m_inst = stoul(data.substr(start), &idx);
-		start += idx + 1;
-		m_damped = (stoul(data.substr(start), &idx) == 1);
+		start += idx;
+		if (start < data.size() && data[start] == ',')
+		{
+			start++;
+			m_realtimeNs = stoll(data.substr(start), &idx);
+			start += idx + 1;
+			m_monotonicNs = stoull(data.substr(start), &idx);
+		}
 	} catch (exception& e)
 	{
         (void)e;
@@ -122,13 +134,58 @@ double BgObservation::getVal()
     return m_val;
 }
 
+/**
+ * @brief Accessor for the 'instance' value.
+ * @return The instance of the data item (e.g. which of several sensors).
+*/
+int BgObservation::getInst()
+{
+    return m_inst;
+}
+
+/**
+ * @brief Accessor for the 'monotonicNs' value.
+ * @return The steady clock when the message was received (ns; 0 if unknown).
+*/
+uint64_t BgObservation::getMonotonicNs()
+{
+    return m_monotonicNs;
+}
+
+/**
+ * @brief Accessor for the 'realtimeNs' value.
+ * @return The system clock when the message was received (ns since 1970; 0 if unknown).
+*/
+int64_t BgObservation::getRealtimeNs()
+{
+    return m_realtimeNs;
+}
+
+/**
+ * @brief Stamp the observation with the time its message was received.
+ * @param monotonicNs The steady clock (ns).
+ * @param realtimeNs The system clock (ns since 1970).
+*/
+void BgObservation::setReceived(uint64_t monotonicNs, int64_t realtimeNs)
+{
+    m_monotonicNs = monotonicNs;
+    m_realtimeNs = realtimeNs;
+}
+
 /**
  * @brief Get a string representation of the Observation data members.
+ *
+ * The receive times (system clock, then steady clock, in ns) are appended
+ * if the observation has them.
+ *
  * @return A string with the comma-separated data values.
 */
 string BgObservation::str() {
     stringstream s;
     s << m_id << "," << m_valid << "," << m_inst << "," << m_damped << "," << setprecision(10) << m_val << "," 
-        << m_sysVal << "," << m_dampedVal << endl;
+        << m_sysVal << "," << m_dampedVal;
+    if (m_realtimeNs != 0)
+        s << "," << m_realtimeNs << "," << m_monotonicNs;
+    s << endl;
     return s.str();
 }
@@ -0,0 +1,167 @@
+/**
+    bg-priority-filter-class.cpp
+
+    A class which rate limits observations by their item's priority class,
+    and sheds the lower priority ones when the logger falls behind.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-priority-filter-class.h"
+#include <algorithm>
+
+// Instances of an item which are rate limited separately (any higher ones share the last one's limit)
+static const int LIMIT_INSTANCES = 4;
+
+// How long a message has waited to be parsed (or how much data is queued on
+// the socket) when the logger has fallen behind
+static const int64_t SHED_HOUSEKEEPING_LAG_NS = 250000000;     // 250 ms
+static const int64_t SHED_NORMAL_LAG_NS = 1000000000;          // 1 s
+static const size_t SHED_HOUSEKEEPING_BACKLOG = 64 * 1024;
+static const size_t SHED_NORMAL_BACKLOG = 256 * 1024;
+
+// How long the logger must have kept up (within half the lag, and a quarter
+// of the backlog, of the lower level) before shedding less
+static const int64_t SHED_RECOVERY_NS = 1000000000;            // 1 s
+
+/**
+ * @brief Constructor.
+ *
+ * Nothing is capped or shed until Init is called.
+*/
+BgPriorityFilter::BgPriorityFilter() :
+    m_shedLevel(SHED_NONE), m_calmSinceNs(0)
+{
+    for (int i = 0; i != PRIORITIES; i++)
+    {
+        m_intervalNs[i] = 0;
+        m_counts[i].admitted = 0;
+        m_counts[i].limited = 0;
+        m_counts[i].shed = 0;
+    }
+}
+
+/**
+ * @brief Set the items' priority classes and the rate caps.
+ *
+ * @param defs The data item definitions (with each item's priority).
+ * @param rates The maximum observations per second of each instance of an
+ *      item, for each priority class (in BgPriority order; 0, or missing,
+ *      for no cap). The critical class is never capped.
+*/
+void BgPriorityFilter::Init(BgDataDefs const& defs, vector<double> const& rates)
+{
+    m_priorities = defs.Priorities();
+    for (int i = 0; i != PRIORITIES; i++)
+    {
+        double rate = (i != PRIORITY_CRITICAL && static_cast<size_t>(i) < rates.size()) ? rates[i] : 0;
+        m_intervalNs[i] = (rate > 0) ? static_cast<int64_t>(1e9 / rate) : 0;
+    }
+    m_lastNs.clear();
+}
+
+/**
+ * @brief Decide how much to shed, from how far behind the logger is.
+ *
+ * Shedding starts as soon as the logger falls behind, but only eases off
+ * once it has kept up for a while (so a burst doesn't flip it on and off
+ * with every message).
+ *
+ * @param lagNs How long the message about to be parsed has waited since it
+ *      was received (ns).
+ * @param backlogBytes The bytes received on the socket and not yet read.
+ * @param nowNs The steady clock now (ns).
+ * @return The BgShedLevel.
+*/
+int BgPriorityFilter::UpdateShedLevel(int64_t lagNs, size_t backlogBytes, int64_t nowNs)
+{
+    lock_guard<mutex> lock(m_shedMutex);
+    int level = SHED_NONE;
+    if (lagNs >= SHED_NORMAL_LAG_NS || backlogBytes >= SHED_NORMAL_BACKLOG)
+        level = SHED_NORMAL;
+    else if (lagNs >= SHED_HOUSEKEEPING_LAG_NS || backlogBytes >= SHED_HOUSEKEEPING_BACKLOG)
+        level = SHED_HOUSEKEEPING;
+    int shedLevel = m_shedLevel.load(memory_order_relaxed);
+    if (level >= shedLevel)
+    {
+        m_shedLevel.store(level, memory_order_relaxed);
+        m_calmSinceNs = 0;
+        return level;
+    }
+
+    // Ease off one level at a time, once well clear of the current one
+    bool calm = (shedLevel == SHED_NORMAL) ?
+        (lagNs < SHED_NORMAL_LAG_NS / 2 && backlogBytes < SHED_NORMAL_BACKLOG / 4) :
+        (lagNs < SHED_HOUSEKEEPING_LAG_NS / 2 && backlogBytes < SHED_HOUSEKEEPING_BACKLOG / 4);
+    if (!calm)
+        m_calmSinceNs = 0;
+    else if (m_calmSinceNs == 0)
+        m_calmSinceNs = nowNs;
+    else if (nowNs - m_calmSinceNs >= SHED_RECOVERY_NS)
+    {
+        m_shedLevel.store(--shedLevel, memory_order_relaxed);
+        m_calmSinceNs = 0;
+    }
+    return shedLevel;
+}
+
+/**
+ * @brief Decide whether to shed an item (before an observation is built for
+ * it).
+ *
+ * @param id The data item id.
+ * @param shedLevel The BgShedLevel (from UpdateShedLevel).
+ * @return True if the item should be dropped.
+*/
+bool BgPriorityFilter::Shed(int id, int shedLevel)
+{
+    if (shedLevel == SHED_NONE || id == 34 || id == 35)
+        return false;
+    int priority = Priority(id);
+    if (priority == PRIORITY_CRITICAL || priority + shedLevel <= PRIORITY_HOUSEKEEPING)
+        return false;
+    m_counts[priority].shed.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Decide whether to process an observation (that was not shed), by
+ * its item's rate cap.
+ *
+ * @param o The observation (its receive time is used for the rate caps).
+ * @return True if the observation should be processed.
+*/
+bool BgPriorityFilter::Admit(BgObservation& o)
+{
+    int id = o.getId();
+    int priority = (id == 34 || id == 35) ? PRIORITY_CRITICAL : Priority(id);
+    BgPriorityCounts& counts = m_counts[priority];
+    if (priority == PRIORITY_CRITICAL)
+    {
+        counts.admitted.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    // Cap each instance's rate (by the time the observations were received)
+    int64_t interval = m_intervalNs[priority];
+    int64_t ns = static_cast<int64_t>(o.getMonotonicNs());
+    size_t slot = static_cast<size_t>(id) * LIMIT_INSTANCES + min(max(o.getInst(), 0), LIMIT_INSTANCES - 1);
+    if (interval > 0 && ns != 0 && id >= 0)
+    {
+        if (slot >= m_lastNs.size())
+            m_lastNs.resize((id + 1) * LIMIT_INSTANCES, 0);
+        int64_t& last = m_lastNs[slot];
+        if (last != 0 && ns - last < interval)
+        {
+            counts.limited.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        last = ns;
+    }
+    counts.admitted.fetch_add(1, memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,261 @@
+/**
+    bg-rollup-writer-class.cpp
+
+    A class which rolls the rows of the .csv file up into 10 second and
+    1 minute summary files.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-rollup-writer-class.h"
+#include "bg-row-accumulator-class.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+// The summary columns before the statistics of the CSV columns
+enum {
+    ROLLUP_UTC = 0,
+    ROLLUP_BOAT = 1,
+    ROLLUP_ROWS = 2,
+    ROLLUP_FIRST_STAT = 3
+};
+
+// Digits written after the decimal point in the "Utc" column (1/10 second)
+static const unsigned char ROLLUP_UTC_PRECISION = 6;
+
+/**
+ * @brief Constructor.
+ *
+ * @param outDir The directory in which to write the summary files.
+ * @param defs The data item definitions (CSV columns, precisions and angles).
+ * @param boat The boat index (written to the "Boat" column).
+ * @param skipCols CSV columns that are not summarized (e.g. the UTC date and time).
+ * @param options Compression and rotation of the summary files.
+*/
+BgRollupWriter::BgRollupWriter(string& outDir, BgDataDefs& defs, int boat, vector<int> const& skipCols,
+    BgFileOptions const& options) :
+    m_outDir(outDir), m_boat(boat)
+{
+    // The summary columns: the period's UTC, the boat, the rows summarized,
+    // then the mean, minimum and maximum of each named CSV column (and an
+    // empty heading after the last, as for the .csv file)
+    vector<string>& headers = defs.Headers();
+    vector<unsigned char>& precisions = defs.Precisions();
+    m_angles = defs.Angles();
+    m_angles.resize(headers.size(), 0);
+    m_outCols.assign(headers.size(), -1);
+    m_headers = { "Utc", "Boat", "Rows" };
+    m_precisions = { ROLLUP_UTC_PRECISION, 0, 0 };
+    for (size_t col = 0; col != headers.size(); col++)
+    {
+        if (headers[col].empty() || find(skipCols.begin(), skipCols.end(), static_cast<int>(col)) != skipCols.end())
+            continue;
+        m_dataCols.push_back(static_cast<int>(col));
+        m_outCols[col] = static_cast<int>(m_headers.size());
+        static const char* STATS[] = { "_mean", "_min", "_max" };
+        for (int stat = 0; stat != 3; stat++)
+        {
+            m_headers.push_back(headers[col] + STATS[stat]);
+            m_precisions.push_back(precisions[col]);
+        }
+    }
+    m_row.assign(m_headers.size(), 0.0);
+    m_rowSeen.Resize(m_headers.size());
+    m_headers.push_back(string());
+
+    static const int SECONDS[] = { 10, 60 };
+    static const char* SUFFIXES[] = { "10s", "1min" };
+    for (int i = 0; i != 2; i++)
+    {
+        Level& level = m_levels[i];
+        level.seconds = SECONDS[i];
+        level.suffix = SUFFIXES[i];
+        level.writer = new BgCsvWriter(m_outDir, options);
+        level.period = -1;
+        level.rows = 0;
+        level.counts.assign(headers.size(), 0);
+        level.sums.assign(headers.size(), 0.0);
+        level.cosSums.assign(headers.size(), 0.0);
+        level.mins.assign(headers.size(), 0.0);
+        level.maxs.assign(headers.size(), 0.0);
+        level.firsts.assign(headers.size(), 0.0);
+        level.negatives.assign(headers.size(), 0);
+    }
+}
+
+/**
+ * @brief Destructor: write the periods still being summarized, and close the files.
+*/
+BgRollupWriter::~BgRollupWriter()
+{
+    Flush();
+    for (int i = 0; i != 2; i++)
+        delete m_levels[i].writer;
+}
+
+/**
+ * @brief Start the summary files for a date (finishing the previous date's files).
+ *
+ * @param utcdate An integer representation of the number of days since Jan 0, 1900.
+*/
+void BgRollupWriter::NewFile(unsigned long int utcdate)
+{
+    Flush();
+
+    // Convert the Excel-format date to a tm struct (in UTC time)
+    double dateExcel = utcdate;
+    time_t tsUnix = (time_t)(dateExcel - 25569) * 86400;
+    struct tm* dateTm = gmtime(&tsUnix);
+    char buffer[100];
+    strftime(buffer, 100, "%Y%m%d-h5000-", dateTm);
+
+    for (int i = 0; i != 2; i++)
+        m_levels[i].writer->Open(m_outDir + buffer + m_levels[i].suffix + ".csv", m_headers);
+}
+
+/**
+ * @brief Add a row of the .csv file to the summaries.
+ *
+ * When the row falls in a new period, the summary of the previous period
+ * is written first.
+ *
+ * @param utcDateTime The Excel-compatible date and time of the row.
+ * @param values The value of each CSV column.
+ * @param updated The columns observed during the row (see BgRowAccumulator::UpdatedFlags).
+*/
+void BgRollupWriter::AddRow(double utcDateTime, vector<double> const& values, BgColumnBitset const& updated)
+{
+    // (The small offset keeps a row on a whole period in that period, despite rounding)
+    double seconds = utcDateTime * 24.0 * 60.0 * 60.0;
+    for (int i = 0; i != 2; i++)
+    {
+        Level& level = m_levels[i];
+        int64_t period = static_cast<int64_t>(floor(seconds / level.seconds + 1e-6));
+        if (period != level.period)
+        {
+            if (level.rows != 0)
+                WritePeriod(level);
+            level.period = period;
+        }
+        level.rows++;
+        Add(level, values, updated);
+    }
+}
+
+/**
+ * @brief Write the summaries of the periods still in progress (e.g. at the
+ * end of a date, or of the session).
+*/
+void BgRollupWriter::Flush()
+{
+    for (int i = 0; i != 2; i++)
+    {
+        if (m_levels[i].rows != 0)
+            WritePeriod(m_levels[i]);
+        m_levels[i].period = -1;
+    }
+}
+
+/**
+ * @brief Update a level's statistics with the observed columns of a row.
+*/
+void BgRollupWriter::Add(Level& level, vector<double> const& values, BgColumnBitset const& updated)
+{
+    size_t columns = min(values.size(), m_outCols.size());
+    for (size_t col = updated.Next(0); col < columns; col = updated.Next(col + 1))
+    {
+        if (m_outCols[col] < 0)
+            continue;
+        double val = values[col];
+        bool first = (level.counts[col]++ == 0);
+        if (first)
+            level.touched.push_back(static_cast<int>(col));
+
+        if (m_angles[col])
+        {
+            // Sum the unit vectors, and track the extremes either side of the first angle
+            double rad = val * (BG_PI / 180.0);
+            level.sums[col] += sin(rad);
+            level.cosSums[col] += cos(rad);
+            level.negatives[col] |= (val < 0);
+            if (first)
+                level.firsts[col] = val;
+            double offset = remainder(val - level.firsts[col], 360.0);
+            level.mins[col] = first ? offset : min(level.mins[col], offset);
+            level.maxs[col] = first ? offset : max(level.maxs[col], offset);
+        }
+        else
+        {
+            level.sums[col] += val;
+            level.mins[col] = first ? val : min(level.mins[col], val);
+            level.maxs[col] = first ? val : max(level.maxs[col], val);
+        }
+    }
+}
+
+/**
+ * @brief Write a level's summary row for its period, and start again.
+*/
+void BgRollupWriter::WritePeriod(Level& level)
+{
+    m_row[ROLLUP_UTC] = level.period * level.seconds / (24.0 * 60.0 * 60.0);
+    m_row[ROLLUP_BOAT] = m_boat;
+    m_row[ROLLUP_ROWS] = level.rows;
+    for (int i = ROLLUP_UTC; i != ROLLUP_FIRST_STAT; i++)
+        m_rowSeen.Set(i);
+
+    for (vector<int>::const_iterator it = level.touched.begin(); it != level.touched.end(); it++)
+    {
+        int col = *it;
+        int out = m_outCols[col];
+        if (m_angles[col])
+        {
+            bool negative = level.negatives[col] != 0;
+            m_row[out] = WrapAngle(atan2(level.sums[col], level.cosSums[col]) * (180.0 / BG_PI), negative);
+            m_row[out + 1] = WrapAngle(level.firsts[col] + level.mins[col], negative);
+            m_row[out + 2] = WrapAngle(level.firsts[col] + level.maxs[col], negative);
+        }
+        else
+        {
+            m_row[out] = level.sums[col] / level.counts[col];
+            m_row[out + 1] = level.mins[col];
+            m_row[out + 2] = level.maxs[col];
+        }
+        for (int i = 0; i != 3; i++)
+            m_rowSeen.Set(out + i);
+
+        level.counts[col] = 0;
+        level.sums[col] = 0.0;
+        level.cosSums[col] = 0.0;
+        level.negatives[col] = 0;
+    }
+    level.writer->WriteObservations(m_row, m_precisions, m_rowSeen);
+
+    level.touched.clear();
+    level.rows = 0;
+    m_rowSeen.ClearAll();
+}
+
+/**
+ * @brief Express an angle from -180 to 180 (if negative angles were
+ * observed), else from 0 to 360.
+*/
+double BgRollupWriter::WrapAngle(double deg, bool negative)
+{
+    deg = fmod(deg, 360.0);
+    if (negative)
+    {
+        if (deg > 180.0)
+            deg -= 360.0;
+        else if (deg <= -180.0)
+            deg += 360.0;
+    }
+    else if (deg < 0)
+        deg += 360.0;
+    return deg;
+}
@@ -0,0 +1,122 @@
+/**
+    bg-row-accumulator-class.cpp
+
+    A class which accumulates the observations for one row of the .csv file,
+    applying each column's clear/hold/mean policy.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-row-accumulator-class.h"
+
+/**
+ * @brief Constructor.
+ *
+ * The accumulator has no columns until Init is called.
+*/
+BgRowAccumulator::BgRowAccumulator()
+{
+}
+
+/**
+ * @brief Size the accumulator for the CSV columns and sort the columns by policy.
+ *
+ * @param defs The data item definitions (columns and their policies).
+ * @param keepCols Columns that are always carried forward (e.g. the UTC
+ *      date and time), whatever their defined policy.
+*/
+void BgRowAccumulator::Init(BgDataDefs const& defs, vector<int> const& keepCols)
+{
+    size_t columns = defs.Columns();
+    m_values.assign(columns, 0.0);
+    m_seen.Resize(columns);
+    m_updated.Resize(columns);
+    m_times.assign(columns, 0.0);
+    m_sums.assign(columns, 0.0);
+    m_cosSums.assign(columns, 0.0);
+    m_counts.assign(columns, 0);
+    m_signed.assign(columns, 0);
+    m_policies = defs.Policies();
+    m_policies.resize(columns, CSV_CLEAR);
+
+    vector<double> maxAges = defs.MaxAges();
+    maxAges.resize(columns, 0.0);
+    for (vector<int>::const_iterator it = keepCols.begin(); it != keepCols.end(); it++)
+    {
+        m_policies[*it] = CSV_HOLD;
+        maxAges[*it] = 0;
+    }
+
+    m_clearCols.clear();
+    m_holdCols.clear();
+    m_holdMaxAges.clear();
+    m_statCols.clear();
+    for (size_t col = 0; col != columns; col++)
+    {
+        switch (m_policies[col]) {
+        case CSV_HOLD:
+            if (maxAges[col] > 0)
+            {
+                m_holdCols.push_back(static_cast<int>(col));
+                m_holdMaxAges.push_back(maxAges[col]);
+            }
+            break;
+        case CSV_CLEAR:
+            m_clearCols.push_back(static_cast<int>(col));
+            break;
+        default:
+            m_statCols.push_back(static_cast<int>(col));
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Drop held values that are too old to be carried into the next row.
+ *
+ * Called just before a row is written.
+ *
+ * @param now The time of the row (seconds, on the same clock as Set).
+*/
+void BgRowAccumulator::Expire(double now)
+{
+    for (size_t i = 0; i != m_holdCols.size(); i++)
+    {
+        int col = m_holdCols[i];
+        if (m_seen.Test(col) && now - m_times[col] > m_holdMaxAges[i])
+        {
+            m_values[col] = 0.0;
+            m_seen.Reset(col);
+        }
+    }
+}
+
+/**
+ * @brief Start a new row, once the current one has been written.
+ *
+ * "clear" columns are reset to 0 (but, as in the Expedition format, continue
+ * to be written once they have been observed); statistics columns start
+ * again and are empty until they are observed again; "hold" columns are
+ * unchanged.
+*/
+void BgRowAccumulator::EndRow()
+{
+    m_updated.ClearAll();
+
+    for (vector<int>::const_iterator it = m_clearCols.begin(); it != m_clearCols.end(); it++)
+        m_values[*it] = 0.0;
+
+    for (vector<int>::const_iterator it = m_statCols.begin(); it != m_statCols.end(); it++)
+    {
+        m_values[*it] = 0.0;
+        m_seen.Reset(*it);
+        m_sums[*it] = 0.0;
+        m_cosSums[*it] = 0.0;
+        m_counts[*it] = 0;
+        m_signed[*it] = 0;
+    }
+}
@@ -0,0 +1,212 @@
+/**
+    bg-sparse-writer-class.cpp
+
+    A class which writes the CSV rows in a compact binary form (and converts
+    such files to the full .csv format).
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-sparse-writer-class.h"
+#include "bg-csv-writer-class.h"
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+/**
+ * @brief Constructor.
+ *
+ * @param outDir The directory in which to write the files.
+*/
+BgSparseWriter::BgSparseWriter(string& outDir) :
+    m_outDir(outDir), m_oFile(NULL)
+{
+}
+
+/**
+ * @brief Write one row: its timestamp, the bitmap of seen columns, and their values.
+ *
+ * @param utc The Excel-compatible date and time of the row.
+ * @param observations The value of each column.
+ * @param seen The columns that have values to be written.
+*/
+void BgSparseWriter::WriteObservations(double utc, vector<double>& observations, BgColumnBitset& seen)
+{
+    // Only write observations if a file is already open
+    if (m_oFile == NULL)
+        return;
+
+    vector<uint64_t> const& words = seen.Words();
+    m_record.resize(1 + sizeof(double) + words.size() * sizeof(uint64_t));
+    char* p = m_record.data();
+    *p++ = 'R';
+    memcpy(p, &utc, sizeof(utc));
+    p += sizeof(utc);
+    memcpy(p, words.data(), words.size() * sizeof(uint64_t));
+
+    for (size_t col = seen.Next(0); col < observations.size(); col = seen.Next(col + 1))
+    {
+        const char* value = reinterpret_cast<const char*>(&observations[col]);
+        m_record.insert(m_record.end(), value, value + sizeof(double));
+    }
+
+    fwrite(m_record.data(), 1, m_record.size(), m_oFile);
+    fflush(m_oFile);
+}
+
+/**
+ * @brief Start a new file (for a new date), beginning with the column headings and precisions.
+ *
+ * @param utcdate An integer representation of the number of days since Jan 0, 1900.
+ * @param trackedItems The column headings.
+ * @param precisions The digits written after the decimal point, for each column.
+*/
+void BgSparseWriter::NewFile(unsigned long utcdate, vector<string>& trackedItems, vector<unsigned char>& precisions)
+{
+    // Close existing file (if any)
+    if (m_oFile)
+        fclose(m_oFile);
+
+    // Open a new output file for observations from this new date
+    m_oFile = fopen(MakeFileName(utcdate).c_str(), "ab");
+    if (m_oFile == NULL)
+        return;
+
+    uint32_t columns = static_cast<uint32_t>(trackedItems.size());
+    fputc('H', m_oFile);
+    fwrite(&columns, sizeof(columns), 1, m_oFile);
+    for (uint32_t col = 0; col != columns; col++)
+    {
+        fwrite(trackedItems[col].c_str(), 1, trackedItems[col].size() + 1, m_oFile);
+        fputc(precisions[col], m_oFile);
+    }
+    fflush(m_oFile);
+}
+
+/**
+ * @brief Convert a sparse file to the full Expedition-style .csv format.
+ *
+ * @param sparseFile The file written by BgSparseWriter.
+ * @param csvFile The .csv file to be written (appended to, if it exists).
+ * @return The number of rows converted, or -1 on error.
+*/
+long BgSparseWriter::ConvertToCsv(string const& sparseFile, string const& csvFile)
+{
+    std::ifstream in(sparseFile, ios::binary);
+    if (!in.is_open())
+    {
+        cerr << "Failed to open file: " << sparseFile << endl;
+        return -1;
+    }
+    vector<char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    string outDir;
+    BgCsvWriter csv(outDir);
+    vector<string> headers;
+    vector<unsigned char> precisions;
+    vector<double> values;
+    BgColumnBitset seen;
+    long rows = 0;
+
+    size_t pos = 0;
+    while (pos < data.size())
+    {
+        char tag = data[pos++];
+        if (tag == 'H')
+        {
+            uint32_t columns;
+            if (pos + sizeof(columns) > data.size())
+                break;
+            memcpy(&columns, &data[pos], sizeof(columns));
+            pos += sizeof(columns);
+            headers.assign(columns, string());
+            precisions.assign(columns, 0);
+            for (uint32_t col = 0; col != columns && pos < data.size(); col++)
+            {
+                const char* end = static_cast<const char*>(memchr(&data[pos], '\0', data.size() - pos));
+                if (end == NULL || static_cast<size_t>(end - data.data()) + 1 >= data.size())
+                {
+                    pos = data.size();
+                    break;
+                }
+                headers[col].assign(&data[pos], end - &data[pos]);
+                pos = (end - data.data()) + 1;
+                precisions[col] = static_cast<unsigned char>(data[pos++]);
+            }
+            values.assign(columns, 0.0);
+            seen.Resize(columns);
+
+            // (The first header starts the .csv file; the columns must not change after that)
+            if (rows == 0 && !csv.Open(csvFile, headers))
+            {
+                cerr << "Failed to open file: " << csvFile << endl;
+                return -1;
+            }
+        }
+        else if (tag == 'R' && !headers.empty())
+        {
+            size_t words = (headers.size() + 63) / 64;
+            if (pos + sizeof(double) + words * sizeof(uint64_t) > data.size())
+                break;
+            pos += sizeof(double);          // (the Utc is also in its own column)
+            vector<uint64_t> bitmap(words);
+            memcpy(bitmap.data(), &data[pos], words * sizeof(uint64_t));
+            pos += words * sizeof(uint64_t);
+
+            seen.ClearAll();
+            bool complete = true;
+            for (size_t w = 0; w != words; w++)
+            {
+                for (uint64_t word = bitmap[w]; word != 0; word &= word - 1)
+                {
+                    size_t col = w * 64 + BgColumnBitset::LowestBit(word);
+                    if (col >= headers.size() || pos + sizeof(double) > data.size())
+                    {
+                        complete = false;
+                        break;
+                    }
+                    memcpy(&values[col], &data[pos], sizeof(double));
+                    pos += sizeof(double);
+                    seen.Set(col);
+                }
+            }
+            if (!complete)
+                break;
+            csv.WriteObservations(values, precisions, seen);
+            rows++;
+        }
+        else
+        {
+            // (A garbled file, e.g. if the logger was not terminated gracefully)
+            cerr << "Unexpected data in " << sparseFile << " at offset " << pos - 1 << endl;
+            break;
+        }
+    }
+    return rows;
+}
+
+/**
+ * @brief Construct the file name, including the date of the observations.
+ *
+ * @param utcdate An integer representing the number of days since Jan 0, 1900.
+ * @return A string with the new file name.
+*/
+string BgSparseWriter::MakeFileName(unsigned long int utcdate)
+{
+    // Convert the Excel-format date to a tm struct (in UTC time)
+    double dateExcel = utcdate;
+    time_t tsUnix = (time_t)(dateExcel - 25569) * 86400;
+    struct tm* dateTm = gmtime(&tsUnix);
+
+    // Create the filename buffer, including the date
+    char buffer[100];
+    strftime(buffer, 100, "%Y%m%d-h5000-cpu-data.bgr", dateTm);
+
+    return m_outDir + string(buffer);
+}
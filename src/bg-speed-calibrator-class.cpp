@@ -0,0 +1,290 @@
+/**
+    bg-speed-calibrator-class.cpp
+
+    A class which compares the boat speed with the GPS, and writes a table
+    of the speed calibration factors by boat speed and heel.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-speed-calibrator-class.h"
+#include "bg-observation-class.h"
+#include "bg-row-accumulator-class.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// A value is compared with the boat speed for this long after it was observed (s)
+static const double MAX_AGE = 2.0;
+
+// Samples are not taken below this boat speed (kn), while turning faster than
+// this (deg/s), or if the factor is outside these limits (a glitch)
+static const double MIN_BSP = 1.0;
+static const double MAX_RATE_OF_TURN = 3.0;
+static const double MIN_FACTOR = 0.5;
+static const double MAX_FACTOR = 2.0;
+
+// The width of the boat speed (kn) and heel (deg) bands
+static const double SPEED_BAND = 1.0;
+static const int HEEL_BAND = 5;
+
+// How often the table is rewritten (the processing clock, s)
+static const double WRITE_INTERVAL = 600.0;
+
+/**
+ * @brief Constructor.
+ *
+ * @param outDir The directory in which to write the table.
+ * @param boat The boat index (written to the "Boat" column).
+*/
+BgSpeedCalibrator::BgSpeedCalibrator(string& outDir, int boat) :
+    m_outDir(outDir), m_boat(boat), m_tableFailed(false), m_now(0), m_nextWrite(-1), m_samples(0)
+{
+    fill(m_values, m_values + INPUTS, 0.0);
+    fill(m_times, m_times + INPUTS, -1.0);
+    for (int s = 0; s != SPEED_BANDS; s++)
+    {
+        for (int h = 0; h != HEEL_BANDS; h++)
+        {
+            Clear(m_bins[s][h].bsp);
+            Clear(m_bins[s][h].sogFactor);
+            Clear(m_bins[s][h].correctedFactor);
+        }
+    }
+}
+
+/**
+ * @brief Destructor: write the final table.
+*/
+BgSpeedCalibrator::~BgSpeedCalibrator()
+{
+    WriteTable();
+}
+
+/**
+ * @brief Name the table for the date of the first file (the factors are
+ * accumulated over the whole session).
+ *
+ * @param utcdate An integer representation of the number of days since Jan 0, 1900.
+*/
+void BgSpeedCalibrator::NewFile(unsigned long int utcdate)
+{
+    if (!m_tableFile.empty())
+        return;
+
+    // Convert the Excel-format date to a tm struct (in UTC time)
+    double dateExcel = utcdate;
+    time_t tsUnix = (time_t)(dateExcel - 25569) * 86400;
+    struct tm* dateTm = gmtime(&tsUnix);
+    char buffer[100];
+    strftime(buffer, 100, "%Y%m%d-h5000-speed-calibration.csv", dateTm);
+    m_tableFile = m_outDir + buffer;
+}
+
+/**
+ * @brief Process an observation (instance 0 of a data item).
+ *
+ * @param id The data item id.
+ * @param val The value.
+ * @param now The processing clock (seconds; see BgBoatLogger::Now).
+*/
+void BgSpeedCalibrator::Observe(int id, double val, double now)
+{
+    int input;
+    switch (id)
+    {
+    case BG_ID_BSP:
+        m_now = now;
+        Sample(val);
+        if (m_nextWrite < 0 || now < m_nextWrite - WRITE_INTERVAL)
+            m_nextWrite = now + WRITE_INTERVAL;
+        else if (now >= m_nextWrite)
+        {
+            WriteTable();
+            m_nextWrite = now + WRITE_INTERVAL;
+        }
+        return;
+    case BG_ID_SOG:
+        input = IN_SOG;
+        break;
+    case BG_ID_COG:
+        input = IN_COG;
+        break;
+    case BG_ID_HDG:
+        input = IN_HDG;
+        break;
+    case BG_ID_SET:
+        input = IN_SET;
+        break;
+    case BG_ID_DRIFT:
+        input = IN_DRIFT;
+        break;
+    case BG_ID_HEEL:
+        input = IN_HEEL;
+        break;
+    case BG_ID_ROT:
+        input = IN_ROT;
+        break;
+    default:
+        return;
+    }
+    m_values[input] = val;
+    m_times[input] = now;
+    m_now = now;
+}
+
+/**
+ * @brief True if an input was observed recently enough to be compared with
+ * the boat speed.
+*/
+bool BgSpeedCalibrator::Fresh(int input) const
+{
+    return m_times[input] >= 0 && m_now >= m_times[input] && m_now - m_times[input] <= MAX_AGE;
+}
+
+/**
+ * @brief Compare a boat speed observation with the latest GPS values, and
+ * add the factors to the bin of its speed and heel.
+*/
+void BgSpeedCalibrator::Sample(double bsp)
+{
+    if (bsp < MIN_BSP || !Fresh(IN_SOG))
+        return;
+    if (Fresh(IN_ROT) && fabs(m_values[IN_ROT]) > MAX_RATE_OF_TURN)
+        return;
+
+    int speedBand = min(static_cast<int>(bsp / SPEED_BAND), SPEED_BANDS - 1);
+    int heelBand = Fresh(IN_HEEL) ? min(static_cast<int>(fabs(m_values[IN_HEEL])) / HEEL_BAND, HEEL_BANDS - 1) : 0;
+    Bin& bin = m_bins[speedBand][heelBand];
+
+    double sogFactor = m_values[IN_SOG] / bsp;
+    if (sogFactor < MIN_FACTOR || sogFactor > MAX_FACTOR)
+        return;
+    Add(bin.bsp, bsp);
+    Add(bin.sogFactor, sogFactor);
+    m_samples++;
+
+    // The velocity over the ground less the current, along the heading
+    if (Fresh(IN_COG) && Fresh(IN_HDG) && Fresh(IN_SET) && Fresh(IN_DRIFT))
+    {
+        double cog = m_values[IN_COG] * (BG_PI / 180.0);
+        double set = m_values[IN_SET] * (BG_PI / 180.0);
+        double hdg = m_values[IN_HDG] * (BG_PI / 180.0);
+        double east = m_values[IN_SOG] * sin(cog) - m_values[IN_DRIFT] * sin(set);
+        double north = m_values[IN_SOG] * cos(cog) - m_values[IN_DRIFT] * cos(set);
+        double correctedFactor = (east * sin(hdg) + north * cos(hdg)) / bsp;
+        if (correctedFactor >= MIN_FACTOR && correctedFactor <= MAX_FACTOR)
+            Add(bin.correctedFactor, correctedFactor);
+    }
+}
+
+/**
+ * @brief Write the table (replacing the last one written): a row for each
+ * speed and heel band with samples, and one for each speed band over all
+ * heels.
+ *
+ * @return True if the table was written.
+*/
+bool BgSpeedCalibrator::WriteTable()
+{
+    if (m_tableFile.empty() || m_samples == 0)
+        return false;
+    ofstream file(m_tableFile, ios::trunc);
+    if (file)
+    {
+        file << "Boat,BSPFrom,BSPTo,HeelFrom,HeelTo,Samples,BSP,BSP_sd,SOGFactor,SOGFactor_sd,"
+            "CorrectedSamples,CorrectedFactor,CorrectedFactor_sd" << endl;
+        for (int s = 0; s != SPEED_BANDS; s++)
+        {
+            double from = s * SPEED_BAND;
+            double to = (s == SPEED_BANDS - 1) ? 99 : from + SPEED_BAND;
+            Bin all;
+            Clear(all.bsp);
+            Clear(all.sogFactor);
+            Clear(all.correctedFactor);
+            for (int h = 0; h != HEEL_BANDS; h++)
+            {
+                Bin const& bin = m_bins[s][h];
+                if (bin.bsp.n == 0)
+                    continue;
+                WriteRow(file, from, to, h * HEEL_BAND, (h == HEEL_BANDS - 1) ? 90 : (h + 1) * HEEL_BAND, bin);
+                Merge(all.bsp, bin.bsp);
+                Merge(all.sogFactor, bin.sogFactor);
+                Merge(all.correctedFactor, bin.correctedFactor);
+            }
+            if (all.bsp.n != 0)
+                WriteRow(file, from, to, 0, 90, all);
+        }
+    }
+    if (!file)
+    {
+        if (!m_tableFailed)
+            cerr << "Unable to write the speed calibration table: " << m_tableFile << endl;
+        m_tableFailed = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Write a row of the table (the standard deviations are blank for
+ * fewer than two samples).
+*/
+void BgSpeedCalibrator::WriteRow(ostream& out, double bspFrom, double bspTo, int heelFrom, int heelTo, Bin const& bin)
+{
+    Stats const* stats[] = { &bin.bsp, &bin.sogFactor, &bin.correctedFactor };
+    int precisions[] = { 2, 4, 4 };
+    out << m_boat << "," << fixed << setprecision(0) << bspFrom << "," << bspTo << "," << heelFrom << "," << heelTo;
+    for (int i = 0; i != 3; i++)
+    {
+        // (The SOG factor has a sample for each boat speed; the corrected factor may not)
+        if (i != 1)
+            out << "," << stats[i]->n;
+        out << "," << setprecision(precisions[i]);
+        if (stats[i]->n != 0)
+            out << stats[i]->mean;
+        out << ",";
+        if (stats[i]->n > 1)
+            out << sqrt(stats[i]->m2 / (stats[i]->n - 1));
+    }
+    out << defaultfloat << endl;
+}
+
+/**
+ * @brief Add a value to a running mean and sum of squared deviations.
+*/
+void BgSpeedCalibrator::Add(Stats& stats, double x)
+{
+    stats.n++;
+    double delta = x - stats.mean;
+    stats.mean += delta / stats.n;
+    stats.m2 += delta * (x - stats.mean);
+}
+
+/**
+ * @brief Combine two running means and sums of squared deviations (Chan et al.).
+*/
+void BgSpeedCalibrator::Merge(Stats& total, Stats const& stats)
+{
+    if (stats.n == 0)
+        return;
+    uint64_t n = total.n + stats.n;
+    double delta = stats.mean - total.mean;
+    total.m2 += stats.m2 + delta * delta * (static_cast<double>(total.n) * stats.n / n);
+    total.mean += delta * stats.n / n;
+    total.n = n;
+}
+
+void BgSpeedCalibrator::Clear(Stats& stats)
+{
+    stats.n = 0;
+    stats.mean = 0;
+    stats.m2 = 0;
+}
@@ -0,0 +1,154 @@
+/**
+    bg-subscription-builder-class.cpp
+
+    A class which builds the outgoing "DataInfoReq" / "DataReq" websocket
+    messages for a set of data item ids.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-subscription-builder-class.h"
+#include <algorithm>
+
+/**
+ * @brief Constructor.
+ *
+ * @param maxItemsPerFrame The maximum number of data item ids to be packed
+ *      into a single request message.
+*/
+BgSubscriptionBuilder::BgSubscriptionBuilder(size_t maxItemsPerFrame) :
+    m_maxItemsPerFrame(max<size_t>(maxItemsPerFrame, 1))
+{
+}
+
+/**
+ * @brief Add a data item id to be requested.
+ *
+ * If the id has already been added, only the number of instances requested
+ * can be increased.
+ *
+ * @param id The data item id.
+ * @param instances The number of instances (0..instances-1) to request.
+*/
+void BgSubscriptionBuilder::Add(int id, int instances)
+{
+    if (id < 0)
+        return;
+    if (static_cast<size_t>(id) >= m_instances.size())
+        m_instances.resize(id + 1);
+    if (m_instances[id] == 0)
+        m_ids.push_back(id);
+    m_instances[id] = max(m_instances[id], max(instances, 1));
+}
+
+/**
+ * @brief Add several data item ids to be requested.
+ *
+ * @param ids The data item ids.
+*/
+void BgSubscriptionBuilder::Add(vector<int> const& ids)
+{
+    for (vector<int>::const_iterator it = ids.begin(); it != ids.end(); it++)
+        Add(*it);
+}
+
+/**
+ * @brief Build the request messages for all of the ids added.
+ *
+ * The ids are split into as few batches as the per-message limit allows.
+ * For each batch, a "DataInfoReq" message (static information about the
+ * items) is followed by a "DataReq" message (requesting repeated updates
+ * of the values of each instance).
+ *
+ * @param infoOnly If true, build only the first "DataInfoReq" message (for
+ *      test mode).
+ * @return The messages, in the order they should be sent.
+*/
+vector<shared_ptr<string const> > BgSubscriptionBuilder::Frames(bool infoOnly) const
+{
+    vector<shared_ptr<string const> > frames;
+    for (size_t first = 0; first < m_ids.size(); first += m_maxItemsPerFrame)
+    {
+        size_t last = min(first + m_maxItemsPerFrame, m_ids.size());
+        vector<int>::const_iterator begin = m_ids.begin() + first;
+        vector<int>::const_iterator end = m_ids.begin() + last;
+        size_t count = last - first;
+
+        // Construct the "DataInfoReq" message string
+        shared_ptr<string> info = make_shared<string>();
+        info->reserve(20 + count * 5);
+        *info += "{\"DataInfoReq\":[";
+        AddIntArray(begin, end, *info);
+        *info += "]}";
+        frames.push_back(info);
+        if (infoOnly)
+            break;
+
+        // Construct the "DataReq" message string
+        shared_ptr<string> values = make_shared<string>();
+        values->reserve(20 + count * 36);
+        *values += "{\"DataReq\":[";
+        AddDataItemArray(first, last, *values);
+        *values += "]}";
+        frames.push_back(values);
+    }
+    return frames;
+}
+
+/**
+ * @brief Add an array of integers to a string that will become a portion of a DataItem request message.
+ *
+ * The B&G websocket interface accepts DataItem messages which can specify more
+ * than one data id to be returned. Since this application requests lots of
+ * data ids, this helper function is intended to help construct the JSON string
+ * to request each data id.
+ *
+ * The constructed JSON query requests repeated updates of each value, with
+ * one entry for each instance to be requested.
+ *
+ * @param first The index (in m_ids) of the first of the data ids to be queried.
+ * @param last One past the index of the last of the data ids to be queried.
+ * @param str A JSON string into which the generated JSON text is to be inserted.
+*/
+void BgSubscriptionBuilder::AddDataItemArray(size_t first, size_t last, string& str) const
+{
+    // iterate through value ids (and instances), inserting them into the target string
+    for (size_t i = first; i != last; i++) {
+        int id = m_ids[i];
+        for (int inst = 0; inst != m_instances[id]; inst++) {
+            if (i != first || inst != 0)
+                str += ",";
+            str += "{\"id\":";
+            str += to_string(id);
+            str += ",\"repeat\":true,\"inst\":";
+            str += to_string(inst);
+            str += "}";
+        }
+    }
+}
+
+/**
+ * @brief Add an array of ints to a string, comma-separated.
+ *
+ * The B&G websocket interface's DataInfo message expects a comma-separated
+ * array of integers representing the ids of the data items for which the
+ * information is requested. This function creates that string from an array
+ * of int's.
+ *
+ * @param first The first of the data ids to be queried.
+ * @param last One past the last of the data ids to be queried.
+ * @param str A JSON string into which the generated text is to be inserted.
+*/
+void BgSubscriptionBuilder::AddIntArray(vector<int>::const_iterator first, vector<int>::const_iterator last, string& str)
+{
+    // iterate through value ids, inserting them into the target string
+    for (vector<int>::const_iterator it = first; it != last; it++) {
+        if (it != first)
+            str += ",";
+        str += to_string(*it);
+    }
+}
@@ -16,6 +16,7 @@
 
 #include "bg-websocket-session-class.h"
 #include "h5000-logger-class.h"
+#include <ctime>
 
 using namespace std;
 
@@ -32,9 +33,12 @@ using namespace std;
  * @param ioc An io_context object to provide asio I/O
  * @see run()
 */
-BgWebsocketSession::BgWebsocketSession(H5000Logger* pApp, net::io_context& ioc, bool debugFlag, bool testFlag)
+BgWebsocketSession::BgWebsocketSession(BgBoatLogger* pApp, net::io_context& ioc, bool debugFlag, bool testFlag)
     : m_app(pApp), m_debugFlag(debugFlag), m_testFlag(testFlag),
-	m_resolver(net::make_strand(ioc)), m_ws(net::make_strand(ioc))
+	m_resolver(net::make_strand(ioc)), m_ws(net::make_strand(ioc)),
+	m_queueLimit(DEFAULT_QUEUE_LIMIT), m_queuePolicy(QueuePolicy::Coalesce), m_writing(false),
+	m_closed(false), m_stats(), m_deflateFlag(false), m_deflateWindowBits(15),
+	m_deflateMemLevel(8), m_cpuMark(0)
 {
     DEBUGOUT("Constructed session.")
 }
@@ -144,13 +148,24 @@ void BgWebsocketSession::on_connect(beast::error_code ec, tcp::resolver::results
             " h5000-logger");
     }));
 
+    // Offer permessage-deflate compression (if desired)
+    if (m_deflateFlag)
+    {
+        websocket::permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.client_max_window_bits = m_deflateWindowBits;
+        pmd.server_max_window_bits = m_deflateWindowBits;
+        pmd.memLevel = m_deflateMemLevel;
+        m_ws.set_option(pmd);
+    }
+
     // Update the host_ string. This will provide the value of the
     // Host HTTP header during the WebSocket handshake.
     // See https://tools.ietf.org/html/rfc7230#section-5.4
     m_host += ':' + to_string(ep.port());
 
     // Perform the websocket handshake
-    m_ws.async_handshake(m_host, "/",
+    m_ws.async_handshake(m_handshakeResponse, m_host, "/",
         beast::bind_front_handler(
             &BgWebsocketSession::on_handshake,
             shared_from_this()));
@@ -168,16 +183,18 @@ void BgWebsocketSession::on_handshake(beast::error_code ec)
         return fail(ec, "handshake");
 
     DEBUGOUT("Session handshake complete.")
+    m_handshakeTime = chrono::steady_clock::now();
+
+    // Did the server accept the offer of compression?
+    m_stats.deflate = m_deflateFlag &&
+        string(m_handshakeResponse[http::field::sec_websocket_extensions]).find("permessage-deflate") != string::npos;
+    DEBUGOUT("permessage-deflate " << (m_stats.deflate ? "negotiated." : "not in use."))
 
     // Subscribe to all "interesting" data with continuous refresh
     m_app->RequestAllValues();
 
     // Read the first message into our buffer (subsequent reads will occur via on_read)
-    m_ws.async_read(
-        m_buffer,
-        beast::bind_front_handler(
-            &BgWebsocketSession::on_read,
-            shared_from_this()));
+    start_read();
     DEBUGOUT("::on_handshake exiting.")
 }
 
@@ -189,7 +206,13 @@ void BgWebsocketSession::on_handshake(beast::error_code ec)
 */
 void BgWebsocketSession::on_read(beast::error_code ec, size_t bytes_transferred)
 {
-    boost::ignore_unused(bytes_transferred);
+    // Add the thread's CPU time since the read was started. This includes
+    // receiving (and, if negotiated, inflating) the frame, but also any other
+    // handlers the thread ran meanwhile (other boats' messages, row and stats
+    // timers, writes), so it is only an upper bound on the cost of the read.
+    // (If the strand has moved to another thread, the time is skipped.)
+    if (this_thread::get_id() == m_cpuThread)
+        m_stats.readWaitCpuNs += thread_cpu_ns() - m_cpuMark;
 
     if (ec)
         return fail(ec, "read");
@@ -198,20 +221,34 @@ void BgWebsocketSession::on_read(beast::error_code ec, size_t bytes_transferred)
     testout << "Message read:    ";
     DEBUGOUT(testout.str())
 
+    m_stats.framesRead++;
+    m_stats.bytesRead += bytes_transferred;
+
+    // Stamp the frame with the time it was received (on both clocks: the
+    // steady clock for intervals and latency, the system clock for the date
+    // and time)
+    uint64_t monotonicNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t realtimeNs = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+    // Capture the raw frame (if desired), straight from the read buffer
+    if (m_app->m_captureWriter)
+        m_app->m_captureWriter->WriteFrame(m_buffer.data().data(), m_buffer.size(), monotonicNs, realtimeNs);
+
+    // Note how much more is already waiting on the socket (how far behind the
+    // logger is, for shedding low priority items)
+    beast::error_code availableEc;
+    m_app->m_socketBacklog.store(beast::get_lowest_layer(m_ws).socket().available(availableEc), memory_order_relaxed);
+
     stringstream ss;
     ss << beast::make_printable(m_buffer.data());
     //DEBUGOUT(ss.str());
-    m_app->handleResponse(ss.str());
+    m_app->handleResponse(ss.str(), monotonicNs, realtimeNs);
 
     // Clear the buffer
     m_buffer.consume(m_buffer.size());
 
     // Read another message
-    m_ws.async_read(
-        m_buffer,
-        beast::bind_front_handler(
-            &BgWebsocketSession::on_read,
-            shared_from_this()));
+    start_read();
     DEBUGOUT("::on_read exiting.")
 }
 
@@ -220,6 +257,7 @@ void BgWebsocketSession::on_read(beast::error_code ec, size_t bytes_transferred)
  * 
  * This function will remove the completed message from the outgoing message queue then,
  * if there are more messages to be sent, will send the next message to the server.
+ * (Popping the front of the deque is O(1), however long the queue has grown.)
  * 
  * @param ec Error code (0 if successful).
  * @param bytes_transferred Number of bytes written to the server.
@@ -234,18 +272,14 @@ void BgWebsocketSession::on_write(beast::error_code ec, size_t bytes_transferred
     DEBUGOUT("Message written.")
 
     // Remove the message from the queue
-    m_queue.erase(m_queue.begin());
+    m_queue.pop_front();
+    m_writing = false;
+    m_stats.messagesSent++;
+    m_stats.queueDepth = m_queue.size();
 
     // Send the next message (if any)
-    if (!m_queue.empty()) {
-        stringstream testout;
-        testout << "Writing message:\n" << *m_queue.front();
-        DEBUGOUT(testout.str())
-        m_ws.async_write(
-            net::buffer(*m_queue.front()),
-            beast::bind_front_handler(&BgWebsocketSession::on_write,
-                shared_from_this()));
-    }
+    if (!m_queue.empty())
+        write_front();
     DEBUGOUT("::on_write exiting.")
 }
 
@@ -258,6 +292,7 @@ void BgWebsocketSession::on_write(beast::error_code ec, size_t bytes_transferred
 */
 void BgWebsocketSession::on_close(beast::error_code ec)
 {
+    m_closed = true;
     if (ec)
         return fail(ec, "close");
 
@@ -276,10 +311,46 @@ void BgWebsocketSession::on_close(beast::error_code ec)
 */
 void BgWebsocketSession::fail(beast::error_code ec, char const* what)
 {
+    m_closed = true;
     cerr << what << ": " << ec.message() << "\n";
     DEBUGOUT("FAIL::")
 }
 
+/**
+ * @brief Set the bound on the outgoing message queue and the back-pressure policy.
+ *
+ * @param limit The maximum number of messages queued (including the one being written).
+ * @param policy What to do with a new message when the queue is full.
+*/
+void BgWebsocketSession::SetQueueLimit(size_t limit, QueuePolicy policy)
+{
+    m_queueLimit = max<size_t>(limit, 1);
+    m_queuePolicy = policy;
+}
+
+/**
+ * @brief Offer permessage-deflate compression when the session connects.
+ *
+ * @param windowBits The maximum deflate window bits (9..15) for both directions.
+ * @param memLevel The deflate memory level (1..9).
+*/
+void BgWebsocketSession::SetDeflate(int windowBits, int memLevel)
+{
+    m_deflateFlag = true;
+    m_deflateWindowBits = min(max(windowBits, 9), 15);
+    m_deflateMemLevel = min(max(memLevel, 1), 9);
+}
+
+/**
+ * @brief Access the session statistics (updating the wire byte count).
+ * @return The statistics.
+*/
+BgSessionStats const& BgWebsocketSession::Stats()
+{
+    m_stats.wireBytesRead = beast::get_lowest_layer(m_ws).rate_policy().BytesRead();
+    return m_stats;
+}
+
 /**
  * @brief Enqueue a message to be sent to the websocket server.
  * 
@@ -290,14 +361,87 @@ void BgWebsocketSession::fail(beast::error_code ec, char const* what)
 */
 void BgWebsocketSession::send(shared_ptr<string const> const& ss)
 {
-    // Always add to queue
-    m_queue.push_back(ss);
-
-    // Are we already writing?
-    if (m_queue.size() > 1)
+    // Add to queue (subject to the back-pressure policy)
+    if (!enqueue(ss))
         return;
 
     // We are not currently writing, so send this immediately
+    if (!m_writing)
+        write_front();
+    DEBUGOUT("::send exiting.")
+}
+
+/**
+ * @brief Enqueue several messages to be sent to the websocket server.
+ *
+ * All of the messages are queued at once; each is written as soon as the
+ * previous write completes (a websocket stream allows only one outstanding
+ * write), without waiting for any response from the server.
+ *
+ * @param messages The messages to be sent, in order.
+*/
+void BgWebsocketSession::send(vector<shared_ptr<string const>> const& messages)
+{
+    for (vector<shared_ptr<string const>>::const_iterator it = messages.begin(); it != messages.end(); it++)
+        enqueue(*it);
+
+    if (!m_writing && !m_queue.empty())
+        write_front();
+    DEBUGOUT("::send exiting.")
+}
+
+/**
+ * @brief Add a message to the outgoing queue, applying the back-pressure policy.
+ *
+ * The message being written (if any) is never discarded.
+ *
+ * @param ss The message to be sent.
+ * @return True if the message was queued; false if it was discarded.
+*/
+bool BgWebsocketSession::enqueue(shared_ptr<string const> const& ss)
+{
+    // Coalesce: a message identical to one still waiting to be sent is redundant
+    if (m_queuePolicy == QueuePolicy::Coalesce)
+    {
+        for (size_t i = m_writing ? 1 : 0; i < m_queue.size(); i++)
+        {
+            if (m_queue[i] == ss || *m_queue[i] == *ss)
+            {
+                m_stats.coalesced++;
+                return false;
+            }
+        }
+    }
+
+    if (m_queue.size() >= m_queueLimit)
+    {
+        // Make room by discarding the oldest message not yet being written
+        size_t oldest = m_writing ? 1 : 0;
+        if (m_queuePolicy == QueuePolicy::DropOldest && m_queue.size() > oldest)
+        {
+            m_queue.erase(m_queue.begin() + oldest);
+            m_stats.dropped++;
+        }
+        else
+        {
+            m_stats.rejected++;
+            return false;
+        }
+    }
+
+    m_queue.push_back(ss);
+    m_stats.queueDepth = m_queue.size();
+    if (m_stats.queueDepth > m_stats.maxQueueDepth)
+        m_stats.maxQueueDepth = m_stats.queueDepth;
+    return true;
+}
+
+/**
+ * @brief Start writing the message at the front of the outgoing queue.
+*/
+void BgWebsocketSession::write_front()
+{
+    m_writing = true;
     stringstream testout;
     testout << "Writing message:\n" << *m_queue.front();
     DEBUGOUT(testout.str())
@@ -305,5 +449,37 @@ void BgWebsocketSession::send(shared_ptr<string const> const& ss)
         net::buffer(*m_queue.front()),
         beast::bind_front_handler(&BgWebsocketSession::on_write,
             shared_from_this()));
-    DEBUGOUT("::send exiting.")
+}
+
+/**
+ * @brief Start an asynchronous read of the next message from the server.
+*/
+void BgWebsocketSession::start_read()
+{
+    m_ws.async_read(
+        m_buffer,
+        beast::bind_front_handler(
+            &BgWebsocketSession::on_read,
+            shared_from_this()));
+    m_cpuMark = thread_cpu_ns();
+    m_cpuThread = this_thread::get_id();
+}
+
+/**
+ * @brief The CPU time consumed by the calling thread.
+ *
+ * (On Windows, where no per-thread clock is readily available, the process
+ * CPU time is used instead.)
+ *
+ * @return CPU time in nanoseconds.
+*/
+uint64_t BgWebsocketSession::thread_cpu_ns()
+{
+#ifndef WIN32
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#else
+    return static_cast<uint64_t>(clock()) * (1000000000ULL / CLOCKS_PER_SEC);
+#endif // WIN32
 }
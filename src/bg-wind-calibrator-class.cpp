@@ -0,0 +1,417 @@
+/**
+    bg-wind-calibrator-class.cpp
+
+    A class which estimates corrections to the wind calibration from the
+    tacks and gybes found by BgManeuverDetector.
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "bg-wind-calibrator-class.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+// A maneuver is used if at least this much of its post window was observed (s),
+// and its TWD shift is no larger than this (deg; a larger one is a wind shift)
+static const double MIN_POST_SECONDS = 15.0;
+static const double MAX_TWD_SHIFT = 30.0;
+
+// A parameter is not estimated if its column of the (scaled) normal equations
+// is this close to a combination of the others' (e.g. a TWS that hardly varied)
+static const double MIN_PIVOT = 5e-3;
+
+// The TWS bands of the suggested corrections (kn)
+static const double TWS_BAND = 2.0;
+
+// How often the report is rewritten (the processing clock, s)
+static const double WRITE_INTERVAL = 600.0;
+
+static const char* PARAMETER_NAMES[WIND_PARAMETERS] = { "a (upwash)", "b (upwash per knot TWS)", "c (per degree of heel)" };
+static const char* PARAMETER_UNITS[WIND_PARAMETERS] = { "deg", "deg/kn", "deg/deg" };
+
+/**
+ * @brief Format an Excel-compatible UTC date and time.
+*/
+static string UtcString(double utcDateTime, const char* format)
+{
+    time_t tsUnix = (time_t)floor((utcDateTime - 25569) * 86400 + 0.5);
+    char buffer[100];
+    strftime(buffer, 100, format, gmtime(&tsUnix));
+    return buffer;
+}
+
+/**
+ * @brief Constructor.
+ *
+ * @param outDir The directory in which to write the report.
+ * @param boat The boat index (reported).
+*/
+BgWindCalibrator::BgWindCalibrator(string& outDir, int boat) :
+    m_outDir(outDir), m_boat(boat), m_reportFailed(false), m_rejected(0),
+    m_asymmetryN(0), m_asymmetryMean(0), m_asymmetryM2(0), m_firstUtc(0), m_lastUtc(0), m_nextWrite(-1),
+    m_sampleCount(0)
+{
+    Clear(m_fits[0]);
+    Clear(m_fits[1]);
+}
+
+/**
+ * @brief Destructor: write the final report.
+*/
+BgWindCalibrator::~BgWindCalibrator()
+{
+    WriteReport();
+}
+
+/**
+ * @brief Name the report for the date of the first file (the estimates
+ * are accumulated over the whole session).
+ *
+ * @param utcdate An integer representation of the number of days since Jan 0, 1900.
+*/
+void BgWindCalibrator::NewFile(unsigned long int utcdate)
+{
+    if (m_reportFile.empty())
+        m_reportFile = m_outDir + UtcString(utcdate, "%Y%m%d-h5000-wind-calibration.txt");
+}
+
+/**
+ * @brief Rewrite the report every WRITE_INTERVAL (called for each
+ * observation, so that the report is kept up to date between maneuvers).
+ *
+ * @param now The processing clock (seconds; see BgBoatLogger::Now).
+*/
+void BgWindCalibrator::Tick(double now)
+{
+    if (m_nextWrite < 0 || now < m_nextWrite - WRITE_INTERVAL)
+        m_nextWrite = now + WRITE_INTERVAL;
+    else if (now >= m_nextWrite)
+    {
+        WriteReport();
+        m_nextWrite = now + WRITE_INTERVAL;
+    }
+}
+
+/**
+ * @brief Add a maneuver to the estimates (the report is rewritten by Tick,
+ * and at the end of the session).
+ *
+ * @param maneuver A maneuver completed by BgManeuverDetector.
+ * @return True if the maneuver was used.
+*/
+bool BgWindCalibrator::AddManeuver(BgManeuver const& maneuver)
+{
+    BgManeuverWindow const& pre = maneuver.pre;
+    BgManeuverWindow const& post = maneuver.post;
+    double shift = remainder(post.mean[MANEUVER_TWD] - pre.mean[MANEUVER_TWD], 360.0);
+    if (!pre.valid[MANEUVER_TWD] || !post.valid[MANEUVER_TWD] || !pre.valid[MANEUVER_TWA] || !post.valid[MANEUVER_TWA]
+        || !pre.valid[MANEUVER_TWS] || !post.valid[MANEUVER_TWS] || maneuver.postSeconds < MIN_POST_SECONDS
+        || (pre.mean[MANEUVER_TWA] < 0) == (post.mean[MANEUVER_TWA] < 0) || fabs(shift) > MAX_TWD_SHIFT)
+    {
+        m_rejected++;
+        return false;
+    }
+
+    // The change, across the maneuver, of each term of the TWA error
+    Sample& s = m_samples[m_sampleCount++ % MAX_SAMPLES];
+    s.utc = maneuver.startUtc;
+    s.type = maneuver.type;
+    s.tws = (pre.mean[MANEUVER_TWS] + post.mean[MANEUVER_TWS]) / 2;
+    double sidePre = (pre.mean[MANEUVER_TWA] < 0) ? -1 : 1;
+    double sidePost = -sidePre;
+    s.x[WIND_UPWASH] = sidePost - sidePre;
+    s.x[WIND_UPWASH_TWS] = sidePost * post.mean[MANEUVER_TWS] - sidePre * pre.mean[MANEUVER_TWS];
+    s.x[WIND_HEEL] = (pre.valid[MANEUVER_HEEL] && post.valid[MANEUVER_HEEL])
+        ? post.mean[MANEUVER_HEEL] - pre.mean[MANEUVER_HEEL] : 0;
+    s.y = shift;
+
+    Fit& fit = m_fits[(maneuver.type == MANEUVER_GYBE) ? 1 : 0];
+    for (int i = 0; i != WIND_PARAMETERS; i++)
+    {
+        for (int j = 0; j != WIND_PARAMETERS; j++)
+            fit.xtx[i][j] += s.x[i] * s.x[j];
+        fit.xty[i] += s.x[i] * s.y;
+    }
+    fit.yty += s.y * s.y;
+    fit.minTws = min(fit.minTws, s.tws);
+    fit.maxTws = max(fit.maxTws, s.tws);
+    fit.n++;
+
+    // The AWA, mirrored across the maneuver, differs from its mirror image by twice the offset
+    s.asymmetry = numeric_limits<double>::quiet_NaN();
+    if (pre.valid[MANEUVER_AWA] && post.valid[MANEUVER_AWA])
+    {
+        s.asymmetry = remainder(pre.mean[MANEUVER_AWA] + post.mean[MANEUVER_AWA], 360.0) / 2;
+        m_asymmetryN++;
+        double delta = s.asymmetry - m_asymmetryMean;
+        m_asymmetryMean += delta / m_asymmetryN;
+        m_asymmetryM2 += delta * (s.asymmetry - m_asymmetryMean);
+    }
+
+    if (m_fits[0].n + m_fits[1].n == 1)
+        m_firstUtc = s.utc;
+    m_lastUtc = s.utc;
+    return true;
+}
+
+/**
+ * @brief Write the report (replacing the last one written).
+ *
+ * @return True if the report was written.
+*/
+bool BgWindCalibrator::WriteReport()
+{
+    if (m_reportFile.empty())
+        return false;
+    ofstream file(m_reportFile, ios::trunc);
+    if (file)
+        Report(file);
+    if (!file)
+    {
+        if (!m_reportFailed)
+            cerr << "Unable to write the wind calibration report: " << m_reportFile << endl;
+        m_reportFailed = true;
+        return false;
+    }
+    return true;
+}
+
+void BgWindCalibrator::Clear(Fit& fit)
+{
+    fit.n = 0;
+    for (int i = 0; i != WIND_PARAMETERS; i++)
+    {
+        fill(fit.xtx[i], fit.xtx[i] + WIND_PARAMETERS, 0.0);
+        fit.xty[i] = 0;
+    }
+    fit.yty = 0;
+    fit.minTws = numeric_limits<double>::infinity();
+    fit.maxTws = -numeric_limits<double>::infinity();
+}
+
+/**
+ * @brief Solve the normal equations for the parameters that the maneuvers
+ * determine: the upwash, then its change with TWS and the heel term, if
+ * they vary independently (and there are maneuvers to spare).
+*/
+void BgWindCalibrator::Solve(Fit const& fit, Solution& solution)
+{
+    double inv[WIND_PARAMETERS][WIND_PARAMETERS];
+    bool used[WIND_PARAMETERS] = { true, false, false };
+    if (fit.n == 0 || !Invert(fit, used, inv))
+        used[WIND_UPWASH] = false;
+    else
+    {
+        for (int k = WIND_UPWASH_TWS; k != WIND_PARAMETERS; k++)
+        {
+            double trial[WIND_PARAMETERS][WIND_PARAMETERS];
+            int count = 1;
+            for (int j = 0; j != WIND_PARAMETERS; j++)
+                count += used[j] ? 1 : 0;
+            used[k] = true;
+            if (fit.n >= static_cast<uint64_t>(count + 2) && Invert(fit, used, trial))
+                copy(&trial[0][0], &trial[0][0] + WIND_PARAMETERS * WIND_PARAMETERS, &inv[0][0]);
+            else
+                used[k] = false;
+        }
+    }
+
+    // beta = inv(X'X) X'y; the residual sum of squares is y'y - beta.X'y
+    int p = 0;
+    double ssr = fit.yty;
+    for (int i = 0; i != WIND_PARAMETERS; i++)
+    {
+        solution.used[i] = used[i];
+        solution.beta[i] = 0;
+        if (!used[i])
+            continue;
+        p++;
+        for (int j = 0; j != WIND_PARAMETERS; j++)
+            solution.beta[i] += used[j] ? inv[i][j] * fit.xty[j] : 0;
+        ssr -= solution.beta[i] * fit.xty[i];
+    }
+    ssr = max(ssr, 0.0);
+    for (int i = 0; i != WIND_PARAMETERS; i++)
+    {
+        solution.stdErr[i] = -1;
+        if (used[i] && fit.n > static_cast<uint64_t>(p))
+            solution.stdErr[i] = sqrt(ssr / (fit.n - p) * inv[i][i]);
+    }
+    solution.rmsBefore = (fit.n != 0) ? sqrt(fit.yty / fit.n) : 0;
+    solution.rmsAfter = (fit.n != 0) ? sqrt(ssr / fit.n) : 0;
+}
+
+/**
+ * @brief Invert the normal equations of the parameters used (Gauss-Jordan,
+ * on the equations scaled to a unit diagonal).
+ *
+ * @return False if a parameter is (nearly) a combination of the others.
+*/
+bool BgWindCalibrator::Invert(Fit const& fit, bool const used[WIND_PARAMETERS], double inv[WIND_PARAMETERS][WIND_PARAMETERS])
+{
+    int index[WIND_PARAMETERS];
+    double scale[WIND_PARAMETERS];
+    int p = 0;
+    for (int i = 0; i != WIND_PARAMETERS; i++)
+    {
+        if (!used[i])
+            continue;
+        if (fit.xtx[i][i] <= 0)
+            return false;
+        index[p] = i;
+        scale[p++] = 1 / sqrt(fit.xtx[i][i]);
+    }
+
+    // [A | I], reduced to [I | inv(A)]
+    double a[WIND_PARAMETERS][2 * WIND_PARAMETERS];
+    for (int r = 0; r != p; r++)
+    {
+        for (int c = 0; c != p; c++)
+        {
+            a[r][c] = fit.xtx[index[r]][index[c]] * scale[r] * scale[c];
+            a[r][p + c] = (r == c) ? 1 : 0;
+        }
+    }
+    for (int c = 0; c != p; c++)
+    {
+        int pivot = c;
+        for (int r = c + 1; r != p; r++)
+        {
+            if (fabs(a[r][c]) > fabs(a[pivot][c]))
+                pivot = r;
+        }
+        if (fabs(a[pivot][c]) < MIN_PIVOT)
+            return false;
+        if (pivot != c)
+            swap_ranges(a[c], a[c] + 2 * p, a[pivot]);
+        double d = a[c][c];
+        for (int k = 0; k != 2 * p; k++)
+            a[c][k] /= d;
+        for (int r = 0; r != p; r++)
+        {
+            if (r == c || a[r][c] == 0)
+                continue;
+            double f = a[r][c];
+            for (int k = 0; k != 2 * p; k++)
+                a[r][k] -= f * a[c][k];
+        }
+    }
+
+    // (Undo the scaling)
+    for (int r = 0; r != p; r++)
+    {
+        for (int c = 0; c != p; c++)
+            inv[index[r]][index[c]] = a[r][p + c] * scale[r] * scale[c];
+    }
+    return true;
+}
+
+/**
+ * @brief Write the estimates, the suggested corrections, and the residual
+ * of each of the last maneuvers used.
+*/
+void BgWindCalibrator::Report(ostream& out)
+{
+    out << "H5000 wind calibration: boat " << m_boat << ", " << m_fits[0].n << " tacks and " << m_fits[1].n
+        << " gybes used (" << m_rejected << " maneuvers not used)" << endl;
+    if (m_sampleCount != 0)
+        out << "From " << UtcString(m_firstUtc, "%Y-%m-%d %H:%M:%S") << " to "
+            << UtcString(m_lastUtc, "%Y-%m-%d %H:%M:%S") << " UTC" << endl;
+    out << fixed << endl;
+
+    // The offset
+    out << "Wind angle offset" << endl;
+    if (m_asymmetryN == 0)
+        out << "  No maneuvers with the AWA observed" << endl;
+    else
+    {
+        out << "  The AWA is " << setprecision(2) << m_asymmetryMean << " deg clockwise of mirrored across "
+            << m_asymmetryN << " maneuvers";
+        if (m_asymmetryN > 1)
+            out << " (+/- " << sqrt(m_asymmetryM2 / (m_asymmetryN - 1) / m_asymmetryN) << ")";
+        out << endl << "  Suggested change to the wind angle offset: " << -m_asymmetryMean << " deg" << endl;
+    }
+    out << endl;
+
+    // The upwash and heel terms, for tacks and gybes
+    Solution solutions[2];
+    char const* names[] = { "Upwind (tacks)", "Downwind (gybes)" };
+    for (int f = 0; f != 2; f++)
+    {
+        Solve(m_fits[f], solutions[f]);
+        ReportFit(out, m_fits[f], solutions[f], names[f]);
+    }
+
+    // The residuals (of the current estimates)
+    out << "Maneuvers used";
+    if (m_sampleCount > MAX_SAMPLES)
+        out << " (the last " << MAX_SAMPLES << ")";
+    out << endl;
+    out << "  Utc       Type  TWS    HeelChange  TWDShift  Fitted  Residual  AWAAsymmetry" << endl;
+    uint64_t first = (m_sampleCount > MAX_SAMPLES) ? m_sampleCount - MAX_SAMPLES : 0;
+    for (uint64_t k = first; k != m_sampleCount; k++)
+    {
+        Sample const* it = &m_samples[k % MAX_SAMPLES];
+        Solution const& solution = solutions[(it->type == MANEUVER_GYBE) ? 1 : 0];
+        double fitted = 0;
+        for (int i = 0; i != WIND_PARAMETERS; i++)
+            fitted += solution.beta[i] * it->x[i];
+        out << "  " << UtcString(it->utc, "%H:%M:%S") << "  " << ((it->type == MANEUVER_GYBE) ? "gybe" : "tack")
+            << setprecision(1) << setw(6) << it->tws << setw(12) << it->x[WIND_HEEL] << setw(10) << it->y
+            << setw(8) << fitted << setw(10) << (it->y - fitted);
+        if (!std::isnan(it->asymmetry))
+            out << setw(14) << it->asymmetry;
+        out << endl;
+    }
+}
+
+/**
+ * @brief Write the estimates for one type of maneuver.
+*/
+void BgWindCalibrator::ReportFit(ostream& out, Fit const& fit, Solution const& solution, char const* name)
+{
+    out << name << endl;
+    if (!solution.used[WIND_UPWASH])
+    {
+        out << "  No maneuvers" << endl << endl;
+        return;
+    }
+    out << "  " << fit.n << " maneuvers, TWS " << setprecision(1) << fit.minTws << " to " << fit.maxTws << " kn" << endl;
+    out << "  TWA error = side x (a + b x TWS) + c x heel" << endl;
+    for (int i = 0; i != WIND_PARAMETERS; i++)
+    {
+        out << "    " << left << setw(26) << PARAMETER_NAMES[i] << right;
+        if (!solution.used[i])
+        {
+            out << "not estimated (too few maneuvers, or it did not vary independently)" << endl;
+            continue;
+        }
+        out << setprecision(3) << setw(8) << solution.beta[i] << " " << PARAMETER_UNITS[i];
+        if (solution.stdErr[i] >= 0)
+            out << " +/- " << solution.stdErr[i];
+        out << endl;
+    }
+    out << "  RMS TWD shift: " << setprecision(2) << solution.rmsBefore << " deg; after the corrections: "
+        << solution.rmsAfter << " deg" << endl;
+
+    // (Positive values widen the TWA)
+    out << "  Suggested change to the true wind angle correction (on both sides):" << endl;
+    for (double tws = floor(fit.minTws / TWS_BAND) * TWS_BAND; tws <= ceil(fit.maxTws / TWS_BAND) * TWS_BAND; tws += TWS_BAND)
+    {
+        out << "    TWS " << setprecision(0) << setw(2) << tws << " kn: " << setprecision(1) << setw(5)
+            << -(solution.beta[WIND_UPWASH] + solution.beta[WIND_UPWASH_TWS] * tws) << " deg" << endl;
+    }
+    if (solution.used[WIND_HEEL])
+        out << "  Suggested heel correction: " << setprecision(3) << -solution.beta[WIND_HEEL]
+            << " deg of TWA per degree of heel" << endl;
+    out << endl;
+}
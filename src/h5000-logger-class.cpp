@@ -12,8 +12,20 @@
 
 #include "h5000-logger-class.h"
 #include "getopt/getopt.h"
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif // WIN32
 
 /// ///////////////////////////////////////////////////////////////////////////
 // Public Member Functions
@@ -32,8 +44,13 @@
 H5000Logger::H5000Logger(int argc, char** argv) : 
     m_hostFlag(false), m_portFlag(false), m_outDirFlag(false), m_debugFlag(false),
 	m_inputLogFlag(false), m_testFlag(false), m_csvFlag(false), m_flatFlag(false),
-	m_csvWriter(NULL), m_flatWriter(NULL), m_session(NULL), m_rawTimestamp(0),
-	m_iFile(NULL)
+	m_dataDefsFlag(false), m_sparseFlag(false), m_convertFlag(false),
+	m_captureFlag(false), m_replayFlag(false), m_replayRealtime(false), m_rollupFlag(false),
+	m_archiveFlag(false), m_queryFlag(false), m_maneuverFlag(false), m_windCalibrationFlag(false),
+	m_speedCalibrationFlag(false), m_itemsPerFrame(DEFAULT_ITEMS_PER_FRAME),
+	m_queueLimit(DEFAULT_QUEUE_LIMIT), m_queuePolicy(QueuePolicy::Coalesce), m_statsInterval(0),
+	m_deflateFlag(false), m_deflateWindowBits(15), m_deflateMemLevel(8),
+	m_threads(1), m_rowInterval(0), m_rowAlignGps(false), m_iFile(NULL), m_startTime(chrono::steady_clock::now())
 {
     // Check command line arguments and populate member variables.
     ProcessCommandLine(argc, argv);
@@ -42,46 +59,80 @@ H5000Logger::H5000Logger(int argc, char** argv) :
 /**
  * @brief Start execution of the logger program.
  * 
- * The logger will attempt to connect to the specified webserver and, if
- * successful, will canvass the server for certain data item values and
- * save the resulting values in log files.
+ * The logger will attempt to connect to the specified webserver(s) and, if
+ * successful, will canvass each server for certain data item values and
+ * save the resulting values in log files. When more than one host is
+ * specified, each boat's files are written to its own subdirectory
+ * (boat0/, boat1/, ...) of the output directory.
  * 
  * @return ERROR_SUCCESS if successful; otherwise, error code.
 */
 int H5000Logger::run()
 {
 
-    // Open BgDataDefs.json and load into a json object
+    // Load the data item definitions (compiled-in, or from BgDataDefs.json)
     LoadDataDefs();
 
+    // Convert a sparse row file to .csv (no logging)
+    if (m_convertFlag)
+        exit(ConvertSparseFile());
+
+    // Convert flat log and .csv files to columnar archives (no logging)
+    if (m_archiveFlag)
+        exit(ConvertToArchives());
 
-    // Create and initialize the CSV output class (if desired)
-    if (m_csvFlag)
+    // Select rows of columnar archives (no logging)
+    if (m_queryFlag)
+        exit(QueryArchives());
+
+    // Replay a capture file (single-threaded, so that it is deterministic)
+    if (m_replayFlag)
     {
-        m_csvWriter = new BgCsvWriter(m_outDir);
+        m_threads = 1;
+        m_boats.push_back(unique_ptr<BgBoatLogger>(new BgBoatLogger(*this, 0, "", "", m_outDir)));
+        int nRet = ReplayCapture();
+        m_boats.clear();
+        exit(nRet);
+    }
 
-        // Special handling if the input should come from a flat log file,
-        // instead of live websocket data
-        if (m_inputLogFlag)
-        {
-            int nRet = ProcessFlatLog();
-            exit(nRet);
-        }
+    // Special handling if the input should come from a flat log file,
+    // instead of live websocket data
+    if (m_inputLogFlag)
+    {
+        m_flatFlag = false;
+        m_boats.push_back(unique_ptr<BgBoatLogger>(new BgBoatLogger(*this, 0, "", "", m_outDir)));
+        int nRet = ProcessFlatLog();
+        m_boats.clear();
+        exit(nRet);
     }
 
-    // Create and initialize the FLAT output class (if desired)
-    if (m_flatFlag)
+    // Create a logger (with its own output directory and websocket session) for each boat
+    for (size_t i = 0; i < m_hosts.size(); i++)
     {
-        m_flatWriter = new BgFlatWriter(m_outDir);
+        string outDir = m_outDir;
+        if (m_hosts.size() > 1)
+        {
+            outDir += "boat" + to_string(i) + "/";
+            if ((m_csvFlag || m_flatFlag) && !MakeOutputDirectory(outDir))
+                exit(-1);
+        }
+        string port = m_hosts[i].second.empty() ? m_port : m_hosts[i].second;
+        m_boats.push_back(unique_ptr<BgBoatLogger>(new BgBoatLogger(*this, static_cast<int>(i), m_hosts[i].first, port, outDir)));
     }
+    for (size_t i = 0; i < m_boats.size(); i++)
+        m_boats[i]->Start();
 
-    // The io_context is required for all I/O
-    net::io_context ioc;
-    m_session = make_shared<BgWebsocketSession>(this, ioc, m_debugFlag, m_testFlag);
-    m_session ->run(m_host.c_str(), m_port.c_str());
+    // Run the I/O service on the requested number of threads. The calls will
+    // return when all of the sockets are closed.
+    vector<thread> threads;
+    for (int i = 1; i < m_threads; i++)
+        threads.push_back(thread([this]() { m_ioc.run(); }));
+    m_ioc.run();
+    for (vector<thread>::iterator it = threads.begin(); it != threads.end(); it++)
+        it->join();
 
-    // Run the I/O service. The call will return when the socket is closed.
-    ioc.run();
+    // Close the output files (writing any compressed frames still queued)
+    m_boats.clear();
 
     return EXIT_SUCCESS;
 }
@@ -89,532 +140,70 @@ int H5000Logger::run()
 #endif
 
 
-/// ///////////////////////////////////////////////////////////////////////////
-// Outgoing websocket message constructors
-/// ///////////////////////////////////////////////////////////////////////////
-
-#if (true)
-
-/**
- * @brief Request all (relevant) values from the H5000 CPU.
- *
- * This function is called when the websocket handshake is successfully 
- * completed to start the stream of data values coming from the websocket 
- * server.
- *
- * @see on_handshake()
-*/
-void H5000Logger::RequestAllValues() {
-
-    // todo Remove hardwired value ids and replace with those "advertised" by the CPU.
-    // todo Periodically request a list of "advertised" value from the CPU (e.g., if new devices have appeared)
-
-    DEBUGOUT("Requesting dataitem info and values.")
-
-    vector<int> dataitems = { 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 17, 18, 19, 21, 23, 27, 30, 31, 32, 33, 34, 35, 37, 39, 40, 41, 42, 44, 45, 46 };
-    RequestDataInfo(dataitems);
-    if (m_testFlag)     // Just ask for one "batch" of values if in test mode
-        return;
-    RequestDataValues(dataitems);
-    
-    dataitems = { 47, 48, 49, 65, 66, 77, 118, 119, 121, 122, 125, 140, 141, 142, 146, 150, 157, 165, 217, 218, 219, 220, 221, 222, 223, 224, 225, 226, 227, 228, 230, 231, 232 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 233, 234, 235, 236, 238, 240, 241, 243, 304, 305, 306, 309, 310, 311, 312, 313, 314, 315, 316, 317, 318, 319, 320, 321, 322, 323, 324, 325, 326, 327 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 328, 329, 330, 331, 332, 333, 334, 335, 336, 337, 338, 339, 340, 341, 342, 343, 344, 345, 346, 347, 348, 349, 350, 351, 352, 353, 354, 355, 356, 357 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 358, 359, 360, 361, 362, 363, 364, 365, 366, 367, 368, 369, 370, 371, 372, 373, 374, 375, 376, 377, 378, 379, 380, 381, 382, 383, 384, 385, 386, 387, 388 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 389, 390, 391, 392, 393, 394, 395, 396, 397, 398, 399, 400, 401, 402, 403, 404, 405, 406, 407, 408, 409, 410, 411, 412, 413, 414, 415, 416, 417, 418, 419 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 420, 421, 422, 423, 424, 425, 426, 427, 428, 429, 432, 433, 434, 435, 436, 437, 438, 439, 440, 441, 442, 443, 444, 445, 446, 447, 448, 449, 450, 451, 452, 453 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 454, 455, 456, 457, 458, 459, 460, 461, 462, 463, 464, 465, 466, 467, 468, 469, 470, 471, 472, 473, 474, 475, 476, 477, 478, 479, 480, 481, 482, 483, 484, 485 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-    dataitems = { 486, 487, 488, 489, 490, 491, 492, 493, 494, 495, 496, 497, 498, 499, 500, 501, 502, 503, 504, 505, 506, 507, 508, 509, 510, 511, 512, 513, 514, 515 };
-    RequestDataInfo(dataitems);
-    RequestDataValues(dataitems);
-}
-
-/**
- * @brief Construct and enqueue a "DataReq" message.
- *
- * The B&G websocket interface provides a "DataReq" message, to query the
- * values and state of one or more data values. This function constructs the
- * outgoing message string, then enqueues it to be sent to the websocket
- * server.
- *
- * The constructed message requests updates of each value ("repeat: true")
- * and queries only instance=0.
- *
- * @param items_ A vector of integers, each representing a data id to be 
- *      queried.
-*/
-void H5000Logger::RequestDataValues(vector<int> items_) {
-
-    // Construct the outgoing message string
-    string sQuery = "{\"DataReq\":[";
-    AddDataItemArray(items_, sQuery);
-    sQuery += "]}";
-    m_session->send(make_shared<string>(sQuery));
-}
-
-/**
- * @brief Construct and enqueue a "DataInfoReq" message.
- *
- * The B&G websocket interface provides a "DataInfoReq" message to get static
- * information about one or more data values (long name, short name, units,
- * etc.).
- *
- * This function constructs a JSON string representing such a message for each
- * data id value in the items_ parameter vector and enqueues it to be sent to
- * the websocket server.
- *
- * @param items_ An array of integers representing the data ids of values for
- * which the information is requested.
-*/
-void H5000Logger::RequestDataInfo(vector<int> items_) {
-
-    // Construct the outgoing message string
-    string sQuery = "{\"DataInfoReq\":[";
-    AddIntArray(items_, sQuery);
-    sQuery += "]}";
-    m_session->send(make_shared<string>(sQuery));
-}
-
-#endif
-
 /// //////////////////////////////////////////////////////////////
-// Incoming websocket message handlers
+// Setup routines
 /// //////////////////////////////////////////////////////////////
 
 #if (true)
-/**
- * @brief Handles an incoming message by converting it to JSON, then calling the handler.
- *
- * @param s A incoming message string.
-*/
-void H5000Logger::handleResponse(string const& s)
-{
-    // If we're in "test" mode, we're done--the response has already been displayed
-    if (m_testFlag) {
-        DEBUGOUT("Test complete.")
-        exit(0);
-    }
-
-    Json::Value root = ConstructJson(s);
-    handleResponse(root);
-}
 
 /**
- * @brief Process an incoming JSON message.
- *
- * At this point, the program only "handles" "Data" and "Many" messages,
- * although the B&G websocket server can send many other types.
+ * @brief Load the data item definitions (shared by all boats).
  *
- * Based on the type of message, a handleXXX function is called to process the
- * specific message type.
- *
- * @param root_ A JSON value representing the message to be handled.
- * @see handleResponse(string&)
-*/
-void H5000Logger::handleResponse(Json::Value& root_)
-{
-    if (root_.isMember("Data") != Json::nullValue) {
-        handleData(root_["Data"]);
-    }
-    if (root_.isMember("Many") != Json::nullValue) {
-        handleData(root_["Many"]);
-    }
-
-}
-
-/**
- * @brief Handle a "Data" JSON message.
- *
- * This function creates an Observation object for each data id in the message
- * (there can be more than one) then, depending on the log output options
- * specified when the BgWebsocketSession 'run' function was called, will add
- * the observation to the log output stream.
- *
- * @param root_ The root of the "Data" JSON message object.
-*/
-void H5000Logger::handleData(Json::Value& root_)
-{
-    for (Json::Value::ArrayIndex idx = 0; idx != root_.size(); idx++) {
-
-        // Construct a BgObservation object from the JSON data
-        BgObservation o(root_[idx]);
-
-        // Process the data if the value is valid
-        if (o.isValid())
-        {
-            ProcessObservation(o);
-        }
-    }
-}
-
-void H5000Logger::ProcessObservation(BgObservation& o)
-{
-
-    unsigned int csvColT, csvColD, csvColO;
-
-    // Select the handling code corresponding to the data id
-    switch (o.getId()) {
-
-    case 34:		// UTC (date)
-    {
-        try {
-            csvColD = m_bgToCsvMap.at(o.getId()) - 1;
-            csvColT = m_bgToCsvMap.at(35) - 1;
-        }
-        catch (out_of_range& e) {
-            cerr << "Out of range exception: " << e.what() << endl;
-            break;
-        }
-
-        // Convert the date from Julian Date to an Excel-compatible date (days since Jan 0, 1900)
-        m_observations[csvColD] = o.getVal() - 2415019;
-        m_obsSeen[csvColD] = true;
-        unsigned long int utcdate = static_cast<int>(m_observations[csvColD]);
-
-        // Test to see if this is the first "datestamp" observed
-        if (m_rawTimestamp == 0)
-        {
-            // Test to see if a timestamp has been observed yet
-//            if (((int)m_observations[csvColT]) != 0)
-            if (m_obsSeen[csvColT])
-            {
-                // OK. We've just observed the first datestamp and have 
-                // received a timestamp, so start a new output file for the 
-                // new date
-                NewDate(utcdate);
-            }
-        }
-        else {
-            // Test to see if the UTC Date has rolled over to the next day
-            // todo Build the test to see if the UTC date has changed
-            if (false) {
-                NewDate(utcdate);
-            }
-        }
-
-        break;
-    }
-
-    case 35:		// UTC (time)
-    {
-        try {
-            csvColT = m_bgToCsvMap.at(o.getId()) - 1;
-            csvColD = m_bgToCsvMap.at(34) - 1;
-        }
-        catch (out_of_range& e) {
-            cerr << "Out of range exception: " << e.what() << endl;
-            break;
-        }
-        m_observations[csvColT] = o.getVal();
-        m_obsSeen[csvColT] = true;
-        unsigned long int utctime = static_cast<int>(m_observations[csvColT]);
-
-        // Test to see if this is the first "timestamp" observed
-        if (m_rawTimestamp == 0)
-        {
-            // Test to see if a 'datestamp' has been observed yet
-            unsigned long int utcdate = static_cast<int>(m_observations[csvColD]);
-            if (m_obsSeen[csvColD])
-            {
-                // OK. We've just observed the first timestamp and have 
-                // previously seen a 'datestamp,' so start a new output file 
-                // for the new date
-                NewDate(utcdate);
-
-                // Set the rawTimestamp
-                m_rawTimestamp = static_cast<uint64_t>(o.getVal());
-            }
-        }
-        else
-        {
-            // Test to see if this time is within 2 seconds of the current stamp
-            if (o.getVal() - m_rawTimestamp > 1.5)
-            {
-                NewTime(utctime);
-            }
-        }
-
-        // Set the time currently being tracked
-        //m_time = o.strVal();
-        break;
-    }
-
-    default:
-        try {
-            csvColO = m_bgToCsvMap.at(o.getId()) - 1;
-        }
-        catch (out_of_range& e) {
-            (void)e;        // silence compiler warnings about unused variables
-            break;
-        }
-        m_observations[csvColO] = o.getVal();
-        m_obsSeen[csvColO] = true;
-        break;
-    }
-
-    // Write all observations to the flat file (if desired)
-    if (m_flatFlag)
-    {
-        m_flatWriter->ProcessObservation(o);
-    }
-
-}
-
-
-/**
- * @brief Test to see if this Json::Value is supposed to be written to the CSV file.
- * 
- * Not all items available on the H5000 CPU are logged to the CSV file. Only
- * those that have a "CsvTrack" or "CsvRequired" member set to 'true' are
- * logged and written.
- * 
- * @param item A JSON element from the BgDataDefs.json file
- * 
- * @return True if this data item should be written; false if not.
-*/
-bool H5000Logger::WriteToCsvTest(Json::Value& item)
-{
-    if (item.isMember("CsvTrack"))
-        if (item["CsvTrack"].asBool() == true)
-            return true;
-    if (item.isMember("CsvRequired"))
-    {
-        if (item["CsvRequired"].asBool() == true)
-            return true;
-    }
-    return false;
-}
-
-
-/**
- * @brief Construct an array of items to be tracked in the CSV file.
+ * By default, the definitions compiled into the application are used (so
+ * no file needs to be parsed at startup). If a BgDataDefs.json file was
+ * specified on the command line, it overrides the compiled-in table (and is
+ * normally loaded from its binary cache, rather than parsed).
  *
- * This function will examine the BgDataDefs.json file, identifying DataItem
- * elements that have a "CsvTrack" member equal to TRUE. It will populate a
- * member variables (m_csvTrackedItems) with the names of the items/columns
- * to be written.
- * @return True if successful; otherwise, false.
+ * @return True if successful (on failure, the application exits).
 */
-bool H5000Logger::AnalyzeDataDefs()
+bool H5000Logger::LoadDataDefs()
 {
-
-    // DataItems is an array of JSON strings, one for each data item
-    Json::Value items = m_bgDataDefs["DataItems"];
-
-    // Construct a vector of the items to be logged to the CSV file
-    // (a vector of strings with the Expedition name of the variable, in the
-    // position corresponding to the CSV file column)
-    m_csvTrackedItems.resize(MAX_CSV_COLUMNS);
-    m_precisions.resize(MAX_CSV_COLUMNS);
-    size_t cols = 0;
-    for (Json::Value::ArrayIndex i = 0; i != items.size(); i++)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (m_dataDefsFlag)
     {
-        Json::Value item = items[i];
-        if (WriteToCsvTest(item))
+        if (!m_dataDefs.LoadJson(m_dataDefsFile))
         {
-
-            if (!item.isMember("CsvHeader"))
-            {
-                cerr << "CsvColumn is missing for item ID: " << item["ID"].asUInt() << endl;
-                continue;
-            }
-            if (!item.isMember("CsvColumn"))
-            {
-                cerr << "CsvHeader is missing for item ID: " << item["ID"].asUInt() << endl;
-                continue;
-            }
-
-            // All required items are present
-            // Determine which CSV column this is and extend the total count if necessary
-            size_t col = item["CsvColumn"].asUInt();
-            if (col > cols) cols = col + 1;
-
-            string header = item["CsvHeader"].asString();
-            m_csvTrackedItems[col - 1] = header;
-            m_ExpNameToCsvCol[item["CsvHeader"].asString()] = item["CsvColumn"].asUInt();
-            m_CsvColtoExpName[item["CsvColumn"].asUInt()] = item["CsvHeader"].asString();
-            m_precisions[item["CsvColumn"].asUInt() - 1] = (unsigned char)item["Decimals"].asUInt();
-
-            // Add this item to the B&G ID to CSV column map
-            if (item.isMember("ID"))
-            {
-                m_bgToCsvMap[item["ID"].asUInt()] = item["CsvColumn"].asUInt();
-                m_BgIDToBgName[item["ID"].asUInt()] = item["Name"].asString();
-                m_BgNameToBgID[item["Name"].asString()] = item["ID"].asUInt();
-            }
-
+            cerr << "Error analyzing " << m_dataDefsFile << endl;
+            exit(-1);
         }
     }
-    m_csvTrackedItems.resize(cols);
-    m_precisions.resize(cols);
-    m_observations.resize(cols);
-    m_obsSeen.resize(cols);
-    return true;
-}
-
-/**
- * @brief Start a new .csv file and re-initialize the collection of observations.
- *
- * @param utcdate_ An integer representation of the number of days since Jan 0, 1900.
-*/
-void H5000Logger::NewDate(unsigned long int utcdate)
-{
-    // Write the accumulated information for the most recent timestamp to 
-    // the .csv file, then close it (if the file was open in the first place)
-    if (m_csvFlag)
+    else
+        m_dataDefs.LoadCompiled();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    DEBUGOUT("Data definitions loaded from " << m_dataDefs.Source() << " in "
+        << fixed << setprecision(3) << elapsed.count() << " ms" << defaultfloat)
+
+    // Check for the columns used to timestamp each row
+    if (m_dataDefs.CsvColumn(34) < 0 || m_dataDefs.CsvColumn(35) < 0 ||
+        m_dataDefs.CsvColumn("Utc") < 0 || m_dataDefs.CsvColumn("Boat") < 0)
     {
-        // Write current observation list to the file
-        m_csvWriter->WriteObservations(m_observations, m_precisions, m_obsSeen);
-        m_csvWriter->NewFile(utcdate, m_csvTrackedItems);
-    }
-
-    if (m_flatFlag)
-    {
-        m_flatWriter->NewFile(utcdate);
-    }
-
-
-    // Clear the stored observations (and zero the time)
-    Clear();
-    unsigned int csvColT;
-    try {
-        csvColT = m_bgToCsvMap.at(35) - 1;
-    }
-    catch (out_of_range& e) {
-        cerr << "Error in NewDate: " << e.what() << endl;
+        cerr << "The data definitions must track UTC date (34), UTC time (35), Utc and Boat" << endl;
         exit(-1);
     }
-    m_obsSeen[csvColT] = false;
-}
-
-/**
- * @brief Write the accumulated observations for the old timestamp to the file.
- *
- * When a new timestamp is observed, the existing observations are written to
- * the .csv output file (identified with the old timestamp), the tracked data
- * values are cleared, and a new collection of observations is started.
- *
- * @param utctime_ An integer representation of the number of seconds since midnight UTC.
-*/
-void H5000Logger::NewTime(unsigned long int utctime)
-{
-    unsigned int csvColT, csvColD, csvColCombo, csvBoat;
-    try {
-        csvColT = m_bgToCsvMap.at(35) - 1;
-        csvColD = m_bgToCsvMap.at(34) - 1;
-        csvColCombo = m_ExpNameToCsvCol["Utc"] - 1;
-        csvBoat = m_ExpNameToCsvCol["Boat"] - 1;
-    }
-    catch (out_of_range& e) {
-        cerr << "Error in NewDate: " << e.what() << endl;
-        exit(-1);
-    }
-
-    // Create an Excel-compatible "Utc" field and populate the "Boat" field with 0
-    double UtcDateTime = m_observations[csvColD] + (m_observations[csvColT] / (24.0 * 60.0 * 60.0));
-    cout << "TS:  " << setprecision(10) << UtcDateTime << endl;
-    m_observations[csvColCombo] = UtcDateTime;
-    m_obsSeen[csvColCombo] = true;
-    m_observations[csvBoat] = 0;
-    m_obsSeen[csvBoat] = true;
-
-    if (m_csvFlag) {
-        m_csvWriter->WriteObservations(m_observations, m_precisions, m_obsSeen);
-    }
-
-    // Clear the stored observations (except date and time)
-    Clear();
-    m_observations[csvColT] = utctime;
-
-    // Set raw timestamp value
-    m_rawTimestamp = static_cast<uint64_t>(m_observations[csvColT]);
+    return true;
 }
 
 /**
- * @brief Clear accumulated observation data from the object.
+ * @brief Create an output directory (if it doesn't already exist).
  *
- * This function is called immediately after a timestamp set of values has been
- * written to the .csv file (so intermittent observations/values are dropped
- * and not carried forward).
+ * @param dir The directory to be created.
+ * @return True if the directory exists (or was created).
 */
-void H5000Logger::Clear()
+bool H5000Logger::MakeOutputDirectory(string const& dir)
 {
-    // Save the date and time most recently observed
-    unsigned int csvColD, csvColT;
-    try {
-        csvColD = m_bgToCsvMap.at(34) - 1;
-        csvColT = m_bgToCsvMap.at(35) - 1;
-    }
-    catch (out_of_range& e) {
-        cerr << "Error in Clear: " << e.what() << endl;
-        exit(-1);
-    }
-
-    double date = m_observations[csvColD];
-    double time = m_observations[csvColT];
-
-    // Clear the entire vector of data observation values
-    fill(m_observations.begin(), m_observations.end(), 0.0);
-
-    // Restore the date and time values to initialize the new set of observations
-    m_observations[csvColD] = date;
-    m_observations[csvColT] = time;
-}
-
-bool H5000Logger::LoadDataDefs()
-{
-    string filename = m_exePath;
-    filename += "resources/BgDataDefs.json";
-    std::ifstream file(filename);
-    if (file.is_open()) {
-        file >> m_bgDataDefs;
-        file.close();
-    }
-    else {
-        cerr << "Couldn't open or read BgDataDefs.json" << endl;
-        exit(-1);
-    }
-
-    if (!AnalyzeDataDefs())
+#ifdef WIN32
+    int nRet = _mkdir(dir.c_str());
+#else
+    int nRet = mkdir(dir.c_str(), 0755);
+#endif // WIN32
+    if (nRet != 0 && errno != EEXIST)
     {
-        cerr << "Error analyzing the BgDataDefs.json file" << endl;
-        exit(-1);
+        cerr << "Failed to create output directory: " << dir << endl;
+        return false;
     }
-
     return true;
 }
 
-/**
- * @brief Handle an incoming "Many" message.
- *
- * The B&G websocket server can encapsulate many messages into one string. This
- * function processes such a "Many" message by accessing each of the
- * encapsulated messages and separately handling each of them.
- *
- * @param root_ The root of the JSON object representing the message.
-*/
-void H5000Logger::handleMany(Json::Value& root_)
-{
-    // root_ is an array of instructions
-    for (Json::Value::ArrayIndex idx = 0; idx != root_.size(); idx++) {
-        handleResponse(root_[idx]);
-    }
-}
-
 #endif
 
 /// //////////////////////////////////////////////////////////////
@@ -633,14 +222,14 @@ void H5000Logger::ProcessCommandLine(int argc, char** argv)
     m_exePath = m_exePath.substr(0, m_exePath.find_last_of('/') + 1);
 #endif // WIN32
 
-    char opts[] = "h:p:o:dl:tcf";
+    char opts[] = "h:p:o:dl:tcfj:b:q:s:z:n:r:a:xu:g:k:m:ewy:vi:RCQ:S:MWB";
     int opt;
     while ((opt = getopt(argc, argv, opts)) != -1)
     {
         switch (opt)
         {
-        case 'h':     // specify host ip (required for live logging)
-            m_host = optarg;
+        case 'h':     // specify host ip(s) (required for live logging)
+            ParseHostOption(optarg);
             m_hostFlag = true;
             break;
         case 'p':
@@ -668,14 +257,110 @@ void H5000Logger::ProcessCommandLine(int argc, char** argv)
         case 'f':
             m_flatFlag = true;
             break;
+        case 'j':
+            m_dataDefsFile = optarg;
+            m_dataDefsFlag = true;
+            break;
+        case 'b':
+            m_itemsPerFrame = max(atoi(optarg), 1);
+            break;
+        case 'q':
+            ParseQueueOption(optarg);
+            break;
+        case 's':
+            m_statsInterval = max(atoi(optarg), 0);
+            break;
+        case 'z':
+            ParseDeflateOption(optarg);
+            break;
+        case 'n':
+            m_threads = max(atoi(optarg), 1);
+            break;
+        case 'r':
+            m_rowInterval = chrono::milliseconds(max(atoi(optarg), 0));
+            break;
+        case 'a':
+            ParseAlignOption(optarg);
+            break;
+        case 'x':
+            m_sparseFlag = true;
+            m_csvFlag = true;
+            break;
+        case 'u':
+            m_sparseFile = optarg;
+            m_convertFlag = true;
+            break;
+        case 'g':
+            m_fileOptions.frameBytes = static_cast<size_t>(max(atoi(optarg), 1)) * 1024;
+            break;
+        case 'k':
+            m_fileOptions.rotateBytes = static_cast<size_t>(max(atoi(optarg), 1)) * 1024 * 1024;
+            break;
+        case 'm':
+            m_fileOptions.rotateSeconds = max(atoi(optarg), 1) * 60;
+            break;
+        case 'e':
+            m_fileOptions.compressClosed = true;
+            break;
+        case 'w':
+            m_captureFlag = true;
+            break;
+        case 'y':
+            m_replayFile = optarg;
+            m_replayFlag = true;
+            m_csvFlag = true;
+            break;
+        case 'v':
+            m_replayRealtime = true;
+            break;
+        case 'i':
+            ParseRateOption(optarg);
+            break;
+        case 'R':
+            m_rollupFlag = true;
+            break;
+        case 'C':
+            m_archiveFlag = true;
+            break;
+        case 'Q':
+            m_queryWhere = optarg;
+            m_queryFlag = true;
+            break;
+        case 'S':
+            m_querySelect = optarg;
+            m_queryFlag = true;
+            break;
+        case 'M':
+            m_maneuverFlag = true;
+            break;
+        case 'W':
+            m_windCalibrationFlag = true;
+            m_maneuverFlag = true;
+            break;
+        case 'B':
+            m_speedCalibrationFlag = true;
+            break;
         default:
             Usage();
             exit(-1);
         }
     }
 
+    // The files to be converted to archives (or queried) follow the options
+    if (m_archiveFlag || m_queryFlag)
+    {
+        for (int i = optind; i < argc; i++)
+            m_inputFiles.push_back(argv[i]);
+        if (m_inputFiles.empty())
+        {
+            cerr << "\nNo files specified to be " << (m_archiveFlag ? "converted (-C)" : "queried (-Q/-S)") << ".\n";
+            Usage();
+            exit(-1);
+        }
+    }
+
     // Test parameter combinations
-    if (!m_hostFlag && !m_inputLogFlag)
+    if (!m_hostFlag && !m_inputLogFlag && !m_convertFlag && !m_replayFlag && !m_archiveFlag && !m_queryFlag)
     {
         cerr << "\nNo HOST_IP or INPUT_LOG specified. This application must be run\n" <<
             "in either \"Live\" or \"Offline\" mode.\n";
@@ -686,112 +371,204 @@ void H5000Logger::ProcessCommandLine(int argc, char** argv)
 
 }
 
-void H5000Logger::Usage()
+/**
+ * @brief Parse the -h (host) option: HOST[:PORT][,HOST[:PORT]...].
+ *
+ * Each host is a boat's H5000 CPU; a host without its own port uses the
+ * port given with -p.
+ *
+ * @param arg The option argument, e.g. "192.168.1.10" or "10.0.0.5,10.0.0.6:2053".
+*/
+void H5000Logger::ParseHostOption(string const& arg)
 {
-    std::cerr << "\n" << 
-        "Usage: h5000-logger [[-h HOST_IP] [-p HOST_PORT] [-c] [-f] [-t] | [-l INPUT_LOG]]\n" <<
-        "                    [-o OUTPUT_DIR] [-d]\n" <<
-        "\nWhere:\n" <<
-        "  Live mode:\n" <<
-        "    -h       The IP address of the websocket server to contact.\n" <<
-        "    -p       The port to use on the websocket server.\n" <<
-        "    -c       Write output to a CSV file, grouped by timestamp.\n" <<
-        "    -f       Write output to a \"flat\" file, one line per data observation.\n" <<
-        "    -t       Run in test mode: just send one message to the webserver and report response.\n\n" <<
-        "  Offline mode:\n" <<
-        "    -l       A \"flat\" log file to be consolidated by timestamp and written to a CSV file.\n\n" <<
-        "  Other options\n" <<
-        "    -o       The directory in which to write output files.\n" <<
-        "    -d       Write debugging messages to console output.\n" <<
-        "\n\n";
+    size_t start = 0;
+    while (start <= arg.size())
+    {
+        size_t comma = arg.find(',', start);
+        if (comma == string::npos)
+            comma = arg.size();
+        string host = arg.substr(start, comma - start);
+        string port;
+        size_t colon = host.find(':');
+        if (colon != string::npos)
+        {
+            port = host.substr(colon + 1);
+            host = host.substr(0, colon);
+        }
+        if (host.empty())
+        {
+            cerr << "Invalid host list: " << arg << endl;
+            Usage();
+            exit(-1);
+        }
+        m_hosts.push_back(make_pair(host, port));
+        start = comma + 1;
+    }
 }
 
-
 /**
- * @brief Add an array of integers to a string that will become a portion of a DataItem request message.
+ * @brief Parse the -q (outgoing queue) option: DEPTH[:POLICY].
  *
- * The B&G websocket interface accepts DataItem messages which can specify more
- * than one data id to be returned. Since this application requests lots of
- * data ids, this helper function is intended to help construct the JSON string
- * to request each data id.
- *
- * At this point, the constructed JSON query will request repeated updates of
- * each value and only anticipates values with instance = 0.
- *
- * @param array An array of ints representing the data ids to be queried.
- * @param str A JSON string into which the generated JSON text is to be inserted.
+ * @param arg The option argument, e.g. "64" or "64:drop".
 */
-void H5000Logger::AddDataItemArray(vector<int> array, string& str) {
+void H5000Logger::ParseQueueOption(string const& arg)
+{
+    size_t colon = arg.find(':');
+    m_queueLimit = max(atoi(arg.substr(0, colon).c_str()), 1);
+    if (colon == string::npos)
+        return;
 
-    // iterate through value ids, inserting them into the target string
-    for (vector<int>::const_iterator it = array.begin(); it != array.end(); it++) {
-        str += "{\"id\":";
-        str += to_string((*it));
-        str += ",\"repeat\":true,\"inst\":0";
-        str += "}";
-        str += ",";
+    string policy = arg.substr(colon + 1);
+    if (policy == "coalesce")
+        m_queuePolicy = QueuePolicy::Coalesce;
+    else if (policy == "drop")
+        m_queuePolicy = QueuePolicy::DropOldest;
+    else if (policy == "reject")
+        m_queuePolicy = QueuePolicy::Reject;
+    else
+    {
+        cerr << "Unknown queue policy: " << policy << endl;
+        Usage();
+        exit(-1);
     }
-
-    // get rid of trailing comma to maintain valid JSON
-    if (!str.empty())
-        str.pop_back();
 }
 
 /**
- * @brief Add an array of ints to a string, comma-separated.
- *
- * The B&G websocket interface's DataInfo message expects a comma-separated
- * array of integers representing the ids of the data items for which the
- * information is requested. This function creates that string from an array
- * of int's.
+ * @brief Parse the -z (permessage-deflate) option: WBITS[:MEMLEVEL].
  *
- * @param array Array of ints (representing the data ids to be queried).
- * @param str A JSON string into which the generated text is to be inserted.
+ * @param arg The option argument, e.g. "15" or "12:4".
 */
-void H5000Logger::AddIntArray(vector<int> array, string& str) {
-
-    // iterate through value ids, inserting them into the target string
-    for (vector<int>::const_iterator it = array.begin(); it != array.end(); it++) {
-        str += to_string(*it);
-        str += ",";
+void H5000Logger::ParseDeflateOption(string const& arg)
+{
+    size_t colon = arg.find(':');
+    m_deflateFlag = true;
+    m_deflateWindowBits = atoi(arg.substr(0, colon).c_str());
+    if (colon != string::npos)
+        m_deflateMemLevel = atoi(arg.substr(colon + 1).c_str());
+    if (m_deflateWindowBits < 9 || m_deflateWindowBits > 15 || m_deflateMemLevel < 1 || m_deflateMemLevel > 9)
+    {
+        cerr << "Invalid deflate settings: " << arg << endl;
+        Usage();
+        exit(-1);
     }
-    if (!str.empty())
-        str.pop_back();
 }
 
 /**
- * @brief Close the output log files (if they're open).
+ * @brief Parse the -a (row alignment) option: wall or gps.
+ *
+ * @param arg The option argument.
 */
-/*
-void H5000Logger::CloseLogFiles() {
-    if (m_fpLog != NULL)
+void H5000Logger::ParseAlignOption(string const& arg)
+{
+    if (arg == "wall")
+        m_rowAlignGps = false;
+    else if (arg == "gps")
+        m_rowAlignGps = true;
+    else
     {
-        fclose(m_fpLog);
+        cerr << "Unknown row alignment: " << arg << endl;
+        Usage();
+        exit(-1);
     }
 }
-*/
 
 /**
- * @brief Create a JSON value from a JSON-formatted string.
+ * @brief Parse the -i (rate cap) option: NORMAL[,HOUSEKEEPING].
  *
- * @param sJson A string with valid JSON
- * @return The new JSON value.
+ * @param arg The option argument: the maximum observations per second of
+ *      each normal (and housekeeping) item, e.g. "10" or "10,1" (0 = no cap).
 */
-Json::Value H5000Logger::ConstructJson(string sJson)
+void H5000Logger::ParseRateOption(string const& arg)
 {
-    Json::CharReaderBuilder builder;
-    Json::CharReader* reader = builder.newCharReader();
+    m_priorityRates.assign(PRIORITIES, 0.0);
+    size_t comma = arg.find(',');
+    char* end;
+    m_priorityRates[PRIORITY_NORMAL] = strtod(arg.c_str(), &end);
+    bool valid = (end != arg.c_str() && (*end == '\0' || *end == ','));
+    m_priorityRates[PRIORITY_HOUSEKEEPING] = m_priorityRates[PRIORITY_NORMAL];
+    if (valid && comma != string::npos)
+    {
+        const char* housekeeping = arg.c_str() + comma + 1;
+        m_priorityRates[PRIORITY_HOUSEKEEPING] = strtod(housekeeping, &end);
+        valid = (end != housekeeping && *end == '\0');
+    }
+    if (!valid || m_priorityRates[PRIORITY_NORMAL] < 0 || m_priorityRates[PRIORITY_HOUSEKEEPING] < 0)
+    {
+        cerr << "Invalid rate caps: " << arg << endl;
+        Usage();
+        exit(-1);
+    }
+}
+
+void H5000Logger::Usage()
+{
+    std::cerr << "\n" << 
+        "Usage: h5000-logger [[-h HOST_IP[:PORT][,...]] [-p HOST_PORT] [-c] [-f] [-t] [-b ITEMS] [-q DEPTH[:POLICY]]\n" <<
+        "                    [-s SECONDS] [-z WBITS[:MEMLEVEL]] [-n THREADS] [-r MS [-a wall|gps]] [-x] [-w]\n" <<
+        "                    [-i NORMAL[,HOUSEKEEPING]]\n" <<
+        "                    | [-l INPUT_LOG [-x]] | [-y CAPTURE_FILE [-v] [-f] [-x]] | [-u SPARSE_FILE]\n" <<
+        "                    | [-C [-n THREADS] FILE...] | [-Q WHERE] [-S COLUMNS] ARCHIVE...]\n" <<
+        "                    [-o OUTPUT_DIR] [-g KB] [-k MB] [-m MINUTES] [-e] [-R] [-M] [-W] [-B] [-j DATA_DEFS] [-d]\n" <<
+        "\nWhere:\n" <<
+        "  Live mode:\n" <<
+        "    -h       The IP address of the websocket server to contact. Separate several servers (one per\n" <<
+        "             boat) with commas; each boat's files are written to OUTPUT_DIR/boatN/.\n" <<
+        "    -p       The port to use on the websocket server.\n" <<
+        "    -c       Write output to a CSV file, grouped by timestamp.\n" <<
+        "    -f       Write output to a \"flat\" file, one line per data observation.\n" <<
+        "    -t       Run in test mode: just send one message to the webserver and report response.\n" <<
+        "    -b       The maximum number of data items per subscription message (default: " << DEFAULT_ITEMS_PER_FRAME << ").\n" <<
+        "    -q       The maximum number of outgoing messages queued (default: " << DEFAULT_QUEUE_LIMIT << ") and what to do\n" <<
+        "             when the queue is full: 'coalesce' duplicates (default), 'drop' the oldest, or 'reject' the new.\n" <<
+        "    -s       Report connection statistics every SECONDS.\n" <<
+        "    -z       Offer permessage-deflate compression, with window bits 9..15 and memory level 1..9 (default: 8).\n" <<
+        "    -n       Run I/O and message parsing on THREADS threads (default: 1).\n" <<
+        "    -r       Write a CSV row every MS milliseconds (default: whenever the UTC time advances).\n" <<
+        "    -a       Align the -r rows to the system clock ('wall', default) or to the GPS time ('gps').\n" <<
+        "    -x       Write the CSV rows in the sparse binary format (.bgr; only the observed columns).\n" <<
+        "    -w       Capture the raw messages received (with their receive times) to a .bgc file, for replay.\n" <<
+        "    -i       Process each normal priority item at most NORMAL times a second (and each housekeeping item at\n" <<
+        "             most HOUSEKEEPING times a second; default: NORMAL). Critical items are never capped.\n\n" <<
+        "  Offline mode:\n" <<
+        "    -l       A \"flat\" log file to be consolidated by timestamp and written to a CSV file.\n" <<
+        "    -y       A capture (.bgc) file to be replayed through the message handlers, as fast as possible.\n" <<
+        "    -v       Replay the capture file at the recorded speed.\n" <<
+        "    -u       A sparse (.bgr) file to be converted to a full CSV file.\n" <<
+        "    -C       Convert the flat log and CSV (.csv) files listed after the options to columnar, compressed\n" <<
+        "             archives (.bga), on THREADS threads (default: one per core), verifying the rows of each.\n" <<
+        "    -Q       Select the rows of the archives (.bga) listed after the options that satisfy every predicate\n" <<
+        "             of WHERE (e.g. \"TWS=8:12,|Heel|<25,|TWA|<90\": NAME=LO:HI, NAME<V or NAME>V; |NAME| tests the\n" <<
+        "             absolute value), writing them to OUTPUT_DIR/h5000-query.csv.\n" <<
+        "    -S       The columns of the selected rows to be written (e.g. \"Utc,TWS,TWA,BSP\"; default: all).\n\n" <<
+        "  Other options\n" <<
+        "    -o       The directory in which to write output files.\n" <<
+        "    -g       Compress the CSV and \"flat\" files (.gz), in independent frames of at least KB kilobytes.\n" <<
+        "    -k       Continue the CSV and \"flat\" files in a new part (e.g. 20200530-flatlog-001.log) every MB megabytes.\n" <<
+        "    -m       Continue the CSV and \"flat\" files in a new part every MINUTES minutes.\n" <<
+        "    -e       Compress (.gz) each CSV and \"flat\" file once it is closed (at rotation or the end of the day).\n" <<
+        "    -R       Also write 10 second and 1 minute summaries (mean/min/max) of the CSV rows (-10s.csv, -1min.csv).\n" <<
+        "    -M       Detect tacks and gybes, and write each (with the means before and after it) to -maneuvers.csv.\n" <<
+        "    -W       Estimate the wind angle offset and upwash/heel corrections from the TWD shift across the tacks\n" <<
+        "             and gybes (implies -M), and write them, with the residuals, to -wind-calibration.txt.\n" <<
+        "    -B       Compare the boat speed with the SOG (and with the GPS speed less the current), and write the\n" <<
+        "             calibration factors by boat speed and heel to -speed-calibration.csv.\n" <<
+        "    -j       A BgDataDefs.json file to use instead of the compiled-in data definitions.\n" <<
+        "    -d       Write debugging messages to console output.\n" <<
+        "\n\n";
+}
+
 
-    Json::Value json;
-    string errors;
-    if (!reader->parse(sJson.c_str(), sJson.c_str() + sJson.size(), &json, &errors))
+/**
+ * @brief Close the output log files (if they're open).
+*/
+/*
+void H5000Logger::CloseLogFiles() {
+    if (m_fpLog != NULL)
     {
-        cerr << "Failed to parse the following string:" << endl << sJson << endl;
-        cerr << "Error(s): " << errors << endl;
-        return Json::nullValue;
+        fclose(m_fpLog);
     }
-    return json;
 }
+*/
 
 #endif
 int H5000Logger::ProcessFlatLog()
@@ -826,7 +603,7 @@ int H5000Logger::ProcessFlatLog()
 
             string s = buffer;
             BgObservation o(s);
-            ProcessObservation(o);
+            m_boats[0]->ProcessObservation(o);
         }
     }
 
@@ -837,3 +614,413 @@ int H5000Logger::ProcessFlatLog()
     return 0;
 }
 
+/**
+ * @brief Convert a sparse row file (written with -x) to the full .csv format.
+ *
+ * The .csv file has the same name as the sparse file (with a .csv
+ * extension), in the output directory.
+ *
+ * @return 0 if successful; otherwise, -1.
+*/
+int H5000Logger::ConvertSparseFile()
+{
+    string name = m_sparseFile;
+#ifdef WIN32
+    name = name.substr(name.find_last_of("\\/") + 1);
+#else
+    name = name.substr(name.find_last_of('/') + 1);
+#endif // WIN32
+    size_t dot = name.find_last_of('.');
+    if (dot != string::npos)
+        name = name.substr(0, dot);
+    string csvFile = m_outDir + name + ".csv";
+
+    long rows = BgSparseWriter::ConvertToCsv(m_sparseFile, csvFile);
+    if (rows < 0)
+        return -1;
+    cout << "Converted " << rows << " rows to " << csvFile << endl;
+    return 0;
+}
+
+/**
+ * @brief Replay a capture file (written with -w) through the message handlers.
+ *
+ * The frames are replayed as fast as possible (reporting the rate, as a
+ * benchmark), or at the speed they were received (-v).
+ *
+ * @return 0 if successful; otherwise, -1.
+*/
+int H5000Logger::ReplayCapture()
+{
+    BgCaptureReader reader;
+    if (!reader.Open(m_replayFile))
+        return -1;
+
+    string frame;
+    uint64_t monotonicNs;
+    int64_t realtimeNs;
+    uint64_t firstNs = 0;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (reader.Next(frame, monotonicNs, realtimeNs))
+    {
+        if (frames == 0)
+            firstNs = monotonicNs;
+        if (m_replayRealtime && monotonicNs > firstNs)
+            this_thread::sleep_until(start + chrono::nanoseconds(monotonicNs - firstNs));
+
+        m_boats[0]->ReplayFrame(frame, monotonicNs, realtimeNs);
+        frames++;
+        bytes += frame.size();
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Replayed " << frames << " messages (" << bytes << " bytes) in " << fixed << setprecision(3)
+        << elapsed.count() << " s (" << setprecision(0) << (elapsed.count() > 0 ? frames / elapsed.count() : 0)
+        << " messages/s)" << defaultfloat << endl;
+    return 0;
+}
+
+
+/**
+ * @brief Convert flat log and .csv files (-C) to columnar, compressed
+ * archives (.bga), in parallel.
+ *
+ * Each file is converted by one thread (the threads take the next file as
+ * they finish), so that a batch of files keeps every core busy. The archive
+ * has the same name as its input (with a .bga extension), in the output
+ * directory, and is read back to verify its rows.
+ *
+ * @return 0 if every file was converted; otherwise, -1.
+*/
+int H5000Logger::ConvertToArchives()
+{
+    // (Only the archives are written)
+    m_csvFlag = false;
+    m_flatFlag = false;
+    m_rollupFlag = false;
+    m_maneuverFlag = false;
+    m_windCalibrationFlag = false;
+    m_speedCalibrationFlag = false;
+
+    size_t threads = (m_threads > 1) ? m_threads : thread::hardware_concurrency();
+    threads = max<size_t>(min(threads, m_inputFiles.size()), 1);
+
+    atomic<size_t> next(0);
+    atomic<int> failed(0);
+    mutex consoleMutex;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    auto convert = [&]() {
+        size_t i;
+        while ((i = next++) < m_inputFiles.size())
+        {
+            string report;
+            bool ok = ConvertToArchive(m_inputFiles[i], report);
+            if (!ok)
+                failed++;
+            lock_guard<mutex> lock(consoleMutex);
+            (ok ? cout : cerr) << report << endl;
+        }
+    };
+    vector<thread> workers;
+    for (size_t i = 1; i < threads; i++)
+        workers.push_back(thread(convert));
+    convert();
+    for (vector<thread>::iterator it = workers.begin(); it != workers.end(); it++)
+        it->join();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Converted " << (m_inputFiles.size() - failed) << " of " << m_inputFiles.size() << " files on "
+        << threads << " threads in " << fixed << setprecision(3) << elapsed.count() << " s" << defaultfloat << endl;
+    return (failed == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Convert one flat log or .csv file to an archive, and verify it.
+ *
+ * @param inFile The file to be converted (a .csv file, else a flat log).
+ * @param report Set to a line reporting the result.
+ * @return True if the file was converted and verified.
+*/
+bool H5000Logger::ConvertToArchive(string const& inFile, string& report)
+{
+    string name = inFile;
+#ifdef WIN32
+    name = name.substr(name.find_last_of("\\/") + 1);
+#else
+    name = name.substr(name.find_last_of('/') + 1);
+#endif // WIN32
+    size_t dot = name.find_last_of('.');
+    string extension = (dot == string::npos) ? "" : name.substr(dot);
+    if (dot != string::npos)
+        name = name.substr(0, dot);
+    string archiveFile = m_outDir + name + ".bga";
+
+    // (The rows, and the sum of their Utc values, are counted as they are
+    // read or consolidated, independently of the writer, to verify the archive)
+    BgArchiveWriter writer;
+    uint64_t rows = 0;
+    double utcSum = 0;
+    bool ok;
+    if (extension == ".csv" || extension == ".CSV")
+        ok = ConvertCsvFile(inFile, writer, archiveFile, rows, utcSum);
+    else
+        ok = ConvertFlatLog(inFile, writer, archiveFile, rows, utcSum);
+    if (!writer.Close())
+        ok = false;
+    if (!ok)
+    {
+        report = "Failed to convert " + inFile;
+        return false;
+    }
+    if (!VerifyArchive(archiveFile, rows, utcSum, report))
+        return false;
+
+    ostringstream oss;
+    oss << "Converted " << rows << " rows of " << inFile << " to " << archiveFile << " (" << writer.Bytes() << " bytes)";
+    report = oss.str();
+    return true;
+}
+
+/**
+ * @brief Convert a .csv file (as written with -c or -l) to an archive.
+ *
+ * The column headings are taken from the file's first line, and the
+ * precisions from the data definitions (where a heading is defined).
+ *
+ * @param inFile The .csv file.
+ * @param writer The archive writer.
+ * @param archiveFile The archive file.
+ * @param rows Set to the rows read from the .csv file.
+ * @param utcSum Set to the sum of their Utc values.
+ * @return True if successful.
+*/
+bool H5000Logger::ConvertCsvFile(string const& inFile, BgArchiveWriter& writer, string const& archiveFile, uint64_t& rows,
+    double& utcSum)
+{
+    ifstream in(inFile);
+    if (!in)
+    {
+        cerr << "Failed to open file: " << inFile << endl;
+        return false;
+    }
+
+    // Split a line into its fields
+    auto split = [](string const& line, vector<string>& fields) {
+        fields.clear();
+        size_t start = 0;
+        while (true)
+        {
+            size_t comma = line.find(',', start);
+            fields.push_back(line.substr(start, (comma == string::npos) ? string::npos : comma - start));
+            if (comma == string::npos)
+                break;
+            start = comma + 1;
+        }
+        if (!fields.empty() && !fields.back().empty() && fields.back().back() == '\r')
+            fields.back().pop_back();
+    };
+
+    string line;
+    vector<string> headers;
+    if (!getline(in, line))
+    {
+        cerr << "Empty file: " << inFile << endl;
+        return false;
+    }
+    split(line, headers);
+
+    // (A row may have more fields than headings, e.g. when the last heading is empty)
+    vector<string> fields;
+    bool haveRow = static_cast<bool>(getline(in, line));
+    if (haveRow)
+        split(line, fields);
+    headers.resize(max(headers.size(), fields.size()));
+
+    vector<unsigned char> precisions(headers.size(), 5);
+    for (size_t col = 0; col != headers.size(); col++)
+    {
+        int defCol = headers[col].empty() ? -1 : m_dataDefs.CsvColumn(headers[col]);
+        if (defCol >= 0)
+            precisions[col] = m_dataDefs.Precisions()[defCol];
+    }
+    if (!writer.Open(archiveFile, headers, precisions))
+        return false;
+
+    int colUtc = static_cast<int>(find(headers.begin(), headers.end(), string("Utc")) - headers.begin());
+    vector<double> values(headers.size());
+    for (; haveRow; haveRow = static_cast<bool>(getline(in, line)))
+    {
+        if (line.empty() || line == "\r")
+            continue;
+        split(line, fields);
+        for (size_t col = 0; col != values.size(); col++)
+        {
+            values[col] = numeric_limits<double>::quiet_NaN();
+            if (col < fields.size() && !fields[col].empty())
+            {
+                char* end;
+                double val = strtod(fields[col].c_str(), &end);
+                if (end != fields[col].c_str())
+                    values[col] = val;
+            }
+        }
+        writer.WriteRow(values);
+        rows++;
+        if (static_cast<size_t>(colUtc) < values.size() && !std::isnan(values[colUtc]))
+            utcSum += values[colUtc];
+    }
+    return !in.bad();
+}
+
+/**
+ * @brief Convert a flat log to an archive (the rows are consolidated by
+ * timestamp, exactly as for the .csv file written with -l).
+ *
+ * @param inFile The flat log file.
+ * @param writer The archive writer.
+ * @param archiveFile The archive file.
+ * @param rows Set to the rows consolidated by the logger.
+ * @param utcSum Set to the sum of their Utc values.
+ * @return True if successful.
+*/
+bool H5000Logger::ConvertFlatLog(string const& inFile, BgArchiveWriter& writer, string const& archiveFile, uint64_t& rows,
+    double& utcSum)
+{
+    FILE* iFile = fopen(inFile.c_str(), "r");
+    if (iFile == NULL)
+    {
+        cerr << "Failed to open file: " << inFile << endl;
+        return false;
+    }
+    if (!writer.Open(archiveFile, m_dataDefs.Headers(), m_dataDefs.Precisions()))
+    {
+        fclose(iFile);
+        return false;
+    }
+
+    // (Each file has its own logger, so that the files can be converted in parallel)
+    BgBoatLogger logger(*this, 0, "", "", m_outDir);
+    logger.ConvertTo(&writer);
+    char buffer[200];
+    while (fgets(buffer, sizeof(buffer), iFile) != NULL)
+    {
+        string s = buffer;
+        BgObservation o(s);
+        logger.ProcessObservation(o);
+    }
+    bool ok = !ferror(iFile);
+    if (!ok)
+        cerr << "Error reading file: " << inFile << endl;
+    fclose(iFile);
+    rows = logger.ArchivedRows();
+    utcSum = logger.ArchivedUtcSum();
+    return ok;
+}
+
+/**
+ * @brief Read an archive back, and check that it holds the rows expected.
+ *
+ * Every column of every block is decompressed (so that a corrupt column,
+ * as well as a missing row, is found), and the Utc values are summed.
+ *
+ * @param archiveFile The archive file.
+ * @param rows The rows that should be in the archive.
+ * @param utcSum The sum of their Utc values (ignored if there is no Utc column).
+ * @param report Set to a line reporting the error (if any).
+ * @return True if the archive is complete, and holds the rows expected.
+*/
+bool H5000Logger::VerifyArchive(string const& archiveFile, uint64_t rows, double utcSum, string& report)
+{
+    BgArchiveReader reader;
+    if (!reader.Open(archiveFile))
+    {
+        report = "Failed to verify " + archiveFile;
+        return false;
+    }
+
+    int colUtc = reader.Column("Utc");
+    vector<int> cols(reader.Columns());
+    for (size_t col = 0; col != cols.size(); col++)
+        cols[col] = static_cast<int>(col);
+    vector<vector<double> > values;
+    double sum = 0;
+    size_t blockRows;
+    while (reader.NextBlock(blockRows))
+    {
+        if (!reader.ReadColumns(cols, values))
+        {
+            report = "Corrupt column in " + archiveFile;
+            return false;
+        }
+        for (size_t row = 0; colUtc >= 0 && row != blockRows; row++)
+        {
+            if (!std::isnan(values[colUtc][row]))
+                sum += values[colUtc][row];
+        }
+    }
+    if (!reader.Complete() || reader.Rows() != rows || reader.RecordedRows() != rows)
+    {
+        ostringstream oss;
+        oss << "Row count mismatch in " << archiveFile << ": expected " << rows << ", read " << reader.Rows()
+            << (reader.Complete() ? "" : " (incomplete)");
+        report = oss.str();
+        return false;
+    }
+    if (colUtc >= 0 && sum != utcSum)
+    {
+        report = "Utc values differ in " + archiveFile;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Select the rows of columnar archives (-Q) and write the requested
+ * columns (-S) of those rows to OUTPUT_DIR/h5000-query.csv.
+ *
+ * The archives are scanned in the order given, so the rows are written in
+ * time order if the archives are listed in date order.
+ *
+ * @return 0 if every archive was scanned; otherwise, -1.
+*/
+int H5000Logger::QueryArchives()
+{
+    BgArchiveQuery query;
+    if (!query.Parse(m_queryWhere, m_querySelect))
+        return -1;
+
+    BgCsvWriter writer(m_outDir);
+    string queryFile = m_outDir + "h5000-query.csv";
+    bool opened = false;
+    int failed = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (vector<string>::const_iterator it = m_inputFiles.begin(); it != m_inputFiles.end(); it++)
+    {
+        BgArchiveReader reader;
+        if (!reader.Open(*it) || !query.Bind(reader, *it))
+        {
+            failed++;
+            continue;
+        }
+        if (!opened)
+        {
+            if (!writer.Open(queryFile, query.Headers()))
+                return -1;
+            opened = true;
+        }
+        if (!query.Run(reader, writer))
+        {
+            cerr << "Failed to read " << *it << endl;
+            failed++;
+        }
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Selected " << query.Selected() << " of " << query.Scanned() << " rows from "
+        << (m_inputFiles.size() - failed) << " archives to " << queryFile << " in " << fixed << setprecision(3)
+        << elapsed.count() << " s (" << setprecision(0) << (elapsed.count() > 0 ? query.Scanned() / elapsed.count() : 0)
+        << " rows/s, " << BgArchiveQuery::Kernel() << ")" << defaultfloat << endl;
+    return (failed == 0) ? 0 : -1;
+}
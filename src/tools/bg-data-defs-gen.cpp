@@ -0,0 +1,225 @@
+/**
+    bg-data-defs-gen.cpp
+
+    Build-time tool: reads resources/BgDataDefs.json and writes
+    include/bg-data-defs-table.h, a constexpr table of the data items tracked
+    in the Expedition-style .csv file. Compiling the table into the
+    application avoids parsing the (large) JSON file at every startup.
+
+    Usage: bg-data-defs-gen INPUT_JSON OUTPUT_HEADER
+
+    Copyright (c) 2020 D. Scott Miller. All rights reserved.
+    This code is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License as published by the Free
+    Software Foundation; either version 2 of the License, or (at your option)
+    any later version.
+*/
+
+#include "json/json.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+/**
+ * @brief Quote a string as a C++ string literal.
+*/
+static string Quote(string const& s)
+{
+    string out = "\"";
+    for (string::const_iterator it = s.begin(); it != s.end(); it++)
+    {
+        if (*it == '"' || *it == '\\')
+            out += '\\';
+        out += *it;
+    }
+    out += '"';
+    return out;
+}
+
+/**
+ * @brief Test to see if a data item is tracked in the CSV file.
+ *
+ * (This must match BgDataDefs::IsTracked.)
+*/
+static bool IsTracked(Json::Value& item)
+{
+    if (item.isMember("CsvTrack") && item["CsvTrack"].asBool())
+        return true;
+    if (item.isMember("CsvRequired") && item["CsvRequired"].asBool())
+        return true;
+    return false;
+}
+
+/**
+ * @brief Test to see if a data item has options which apply whether or not
+ * it is tracked (a flat log change-only filter or a priority).
+ *
+ * (This must match BgDataDefs::HasItemOptions.)
+*/
+static bool HasItemOptions(Json::Value& item)
+{
+    return item.isMember("ID") && (item.isMember("FlatDeadband") || item.isMember("FlatDeadbandPct") ||
+        item.isMember("FlatMaxSilence") || item.isMember("Priority"));
+}
+
+// BgCsvPolicy names, in BgCsvPolicy order
+static const char* POLICY_NAMES[] = { "clear", "hold", "mean", "min", "max", "count", "circmean" };
+static const int POLICIES = sizeof(POLICY_NAMES) / sizeof(POLICY_NAMES[0]);
+
+/**
+ * @brief Convert a "CsvPolicy" (or "CsvStats" entry) name to its BgCsvPolicy value.
+ *
+ * (This must match BgDataDefs::ParsePolicy.)
+ *
+ * @return The value, or -1 if the name is not recognized.
+*/
+static int Policy(string const& name)
+{
+    if (name.empty())
+        return 0;
+    for (int i = 0; i != POLICIES; i++)
+    {
+        if (name == POLICY_NAMES[i])
+            return i;
+    }
+    return -1;
+}
+
+// BgPriority names, in BgPriority order
+static const char* PRIORITY_NAMES[] = { "critical", "normal", "housekeeping" };
+static const int PRIORITIES = sizeof(PRIORITY_NAMES) / sizeof(PRIORITY_NAMES[0]);
+
+/**
+ * @brief Convert an item's "Priority" to its BgPriority value.
+ *
+ * (This must match BgDataDefs::ParsePriority.)
+*/
+static int Priority(Json::Value& item)
+{
+    string name = item["Priority"].asString();
+    if (name.empty())
+        return 1;
+    for (int i = 0; i != PRIORITIES; i++)
+    {
+        if (name == PRIORITY_NAMES[i])
+            return i;
+    }
+    cerr << "Unknown Priority for item ID: " << item["ID"].asUInt() << " (using \"normal\")" << endl;
+    return 1;
+}
+
+/**
+ * @brief Convert an item's "CsvStats" to its statistics bits (1 << BgCsvPolicy).
+ *
+ * (This must match BgDataDefs::ParseStats.)
+*/
+static int Stats(Json::Value& item)
+{
+    int stats = 0;
+    Json::Value names = item["CsvStats"];
+    for (Json::Value::ArrayIndex i = 0; i != names.size(); i++)
+    {
+        int stat = Policy(names[i].asString());
+        if (stat < 2)
+        {
+            cerr << "Unknown CsvStats entry for item ID: " << item["ID"].asUInt() << " (ignored)" << endl;
+            return 0;
+        }
+        stats |= 1 << stat;
+    }
+    return stats;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        cerr << "Usage: bg-data-defs-gen INPUT_JSON OUTPUT_HEADER" << endl;
+        return -1;
+    }
+
+    Json::Value root;
+    std::ifstream in(argv[1]);
+    if (!in.is_open())
+    {
+        cerr << "Couldn't open or read " << argv[1] << endl;
+        return -1;
+    }
+    in >> root;
+
+    // Emit one table row for each tracked item, or item with flat log or
+    // priority options (in BgDataDefs.json order, so that later duplicates
+    // override earlier ones, as with the JSON loader)
+    stringstream rows;
+    size_t count = 0;
+    Json::Value items = root["DataItems"];
+    for (Json::Value::ArrayIndex i = 0; i != items.size(); i++)
+    {
+        Json::Value item = items[i];
+        bool tracked = IsTracked(item);
+        if (!tracked && !HasItemOptions(item))
+            continue;
+        if (tracked && (!item.isMember("CsvHeader") || !item.isMember("CsvColumn")))
+            continue;
+
+        int policy = Policy(item["CsvPolicy"].asString());
+        if (policy < 0)
+        {
+            cerr << "Unknown CsvPolicy for item ID: " << item["ID"].asUInt() << " (using \"clear\")" << endl;
+            policy = 0;
+        }
+
+        rows << "    { "
+            << (item.isMember("ID") ? item["ID"].asInt() : -1) << ", "
+            << Quote(item["Name"].asString()) << ", "
+            << (tracked ? item["CsvColumn"].asInt() : 0) << ", "
+            << Quote(tracked ? item["CsvHeader"].asString() : string()) << ", "
+            << item["Decimals"].asUInt() << ", "
+            << item["Group"].asInt() << ", "
+            << Quote(item["Units"].asString()) << ", "
+            << (item.isMember("Instances") ? max(item["Instances"].asInt(), 1) : 1) << ", "
+            << policy << ", "
+            << item["CsvMaxAge"].asDouble() << ", "
+            << Stats(item) << ", "
+            << max(item["FlatDeadband"].asDouble(), 0.0) << ", "
+            << max(item["FlatDeadbandPct"].asDouble(), 0.0) << ", "
+            << max(item["FlatMaxSilence"].asDouble(), 0.0) << ", "
+            << Priority(item) << " },\n";
+        count++;
+    }
+
+    std::ofstream out(argv[2]);
+    if (!out.is_open())
+    {
+        cerr << "Couldn't write " << argv[2] << endl;
+        return -1;
+    }
+    out << "/**\n"
+        << "    bg-data-defs-table.h\n"
+        << "\n"
+        << "    GENERATED FILE - DO NOT EDIT. Produced by src/tools/bg-data-defs-gen.cpp\n"
+        << "    from resources/BgDataDefs.json (run 'make' in build/gcc to regenerate).\n"
+        << "*/\n"
+        << "\n"
+        << "#ifndef __BG_DATA_DEFS_TABLE_H\n"
+        << "#define __BG_DATA_DEFS_TABLE_H\n"
+        << "\n"
+        << "#include \"bg-data-defs-class.h\"\n"
+        << "#include <cstddef>\n"
+        << "\n"
+        << "// id, name, csvColumn, csvHeader, decimals, group, units, instances, policy, maxAge, stats,\n"
+        << "// deadband, deadbandPct, maxSilence, priority\n"
+        << "constexpr BgDataDef g_bgDataDefs[] = {\n"
+        << rows.str()
+        << "};\n"
+        << "\n"
+        << "constexpr size_t BG_DATA_DEFS_COUNT = " << count << ";\n"
+        << "\n"
+        << "#endif  // __BG_DATA_DEFS_TABLE_H\n";
+
+    return 0;
+}